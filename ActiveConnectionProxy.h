@@ -0,0 +1,139 @@
+/*
+ *	This file was automatically generated by dbusxx-xml2cpp; DO NOT EDIT!
+ */
+
+#ifndef __dbusxx__ActiveConnectionProxy_h__PROXY_MARSHAL_H
+#define __dbusxx__ActiveConnectionProxy_h__PROXY_MARSHAL_H
+
+#include <dbus-c++/dbus.h>
+#include <cassert>
+
+namespace org {
+namespace freedesktop {
+namespace NetworkManager {
+namespace Connection {
+
+class Active_proxy
+: public ::DBus::InterfaceProxy
+{
+public:
+
+    Active_proxy()
+    : ::DBus::InterfaceProxy("org.freedesktop.NetworkManager.Connection.Active")
+    {
+        connect_signal(Active_proxy, StateChanged, _StateChanged_stub);
+        connect_signal(Active_proxy, PropertiesChanged, _PropertiesChanged_stub);
+    }
+
+public:
+
+    /* properties exported by this interface */
+        const ::DBus::Path Connection() {
+            ::DBus::CallMessage call ;
+             call.member("Get"); call.interface("org.freedesktop.DBus.Properties");
+            ::DBus::MessageIter wi = call.writer(); 
+            const std::string interface_name = "org.freedesktop.NetworkManager.Connection.Active";
+            const std::string property_name  = "Connection";
+            wi << interface_name;
+            wi << property_name;
+            ::DBus::Message ret = this->invoke_method (call);
+            ::DBus::MessageIter ri = ret.reader ();
+            ::DBus::Variant argout; 
+            ri >> argout;
+            return argout;
+        };
+        const std::string Id() {
+            ::DBus::CallMessage call ;
+             call.member("Get"); call.interface("org.freedesktop.DBus.Properties");
+            ::DBus::MessageIter wi = call.writer(); 
+            const std::string interface_name = "org.freedesktop.NetworkManager.Connection.Active";
+            const std::string property_name  = "Id";
+            wi << interface_name;
+            wi << property_name;
+            ::DBus::Message ret = this->invoke_method (call);
+            ::DBus::MessageIter ri = ret.reader ();
+            ::DBus::Variant argout; 
+            ri >> argout;
+            return argout;
+        };
+        const std::string Uuid() {
+            ::DBus::CallMessage call ;
+             call.member("Get"); call.interface("org.freedesktop.DBus.Properties");
+            ::DBus::MessageIter wi = call.writer(); 
+            const std::string interface_name = "org.freedesktop.NetworkManager.Connection.Active";
+            const std::string property_name  = "Uuid";
+            wi << interface_name;
+            wi << property_name;
+            ::DBus::Message ret = this->invoke_method (call);
+            ::DBus::MessageIter ri = ret.reader ();
+            ::DBus::Variant argout; 
+            ri >> argout;
+            return argout;
+        };
+        const std::vector< ::DBus::Path > Devices() {
+            ::DBus::CallMessage call ;
+             call.member("Get"); call.interface("org.freedesktop.DBus.Properties");
+            ::DBus::MessageIter wi = call.writer(); 
+            const std::string interface_name = "org.freedesktop.NetworkManager.Connection.Active";
+            const std::string property_name  = "Devices";
+            wi << interface_name;
+            wi << property_name;
+            ::DBus::Message ret = this->invoke_method (call);
+            ::DBus::MessageIter ri = ret.reader ();
+            ::DBus::Variant argout; 
+            ri >> argout;
+            return argout;
+        };
+        const uint32_t State() {
+            ::DBus::CallMessage call ;
+             call.member("Get"); call.interface("org.freedesktop.DBus.Properties");
+            ::DBus::MessageIter wi = call.writer(); 
+            const std::string interface_name = "org.freedesktop.NetworkManager.Connection.Active";
+            const std::string property_name  = "State";
+            wi << interface_name;
+            wi << property_name;
+            ::DBus::Message ret = this->invoke_method (call);
+            ::DBus::MessageIter ri = ret.reader ();
+            ::DBus::Variant argout; 
+            ri >> argout;
+            return argout;
+        };
+public:
+
+    /* methods exported by this interface,
+     * this functions will invoke the corresponding methods on the remote objects
+     */
+
+public:
+
+    /* signal handlers for this interface
+     */
+    virtual void StateChanged(const uint32_t& state, const uint32_t& reason) = 0;
+    virtual void PropertiesChanged(const std::map< std::string, ::DBus::Variant >& properties) = 0;
+
+private:
+
+    /* unmarshalers (to unpack the DBus message before calling the actual signal handler)
+     */
+    void _StateChanged_stub(const ::DBus::SignalMessage &sig)
+    {
+        ::DBus::MessageIter ri = sig.reader();
+
+        uint32_t state;
+        ri >> state;
+        uint32_t reason;
+        ri >> reason;
+        StateChanged(state, reason);
+    }
+    void _PropertiesChanged_stub(const ::DBus::SignalMessage &sig)
+    {
+        ::DBus::MessageIter ri = sig.reader();
+
+        std::map< std::string, ::DBus::Variant > properties;
+        ri >> properties;
+        PropertiesChanged(properties);
+    }
+};
+
+} } } } 
+#endif //__dbusxx__ActiveConnectionProxy_h__PROXY_MARSHAL_H
@@ -0,0 +1,31 @@
+#ifndef APP_CONTEXT_H
+#define APP_CONTEXT_H
+
+#include "NetworkState.h"
+#include "DeviceTable.h"
+#include "EventRing.h"
+#include "JobTable.h"
+#include "NetworkRefresher.h"
+#include "ConnectivityCache.h"
+#include "SharedSnapshot.h"
+
+// Long-lived state shared by the resources of one FastCGI process. The
+// resources themselves are created per request and only hold a reference.
+struct AppContext {
+	NetworkState & state;
+	EventRing & events;
+	DeviceState & devices;
+	JobTable & jobs;
+	int maxEventStreams; // event streams hold a worker each
+	NetworkRefresher * refresher; // optional; 0 when the state is fed directly
+	ConnectionControl * connections; // optional; 0 answers /connections with 404
+	ConnectivityCache * connectivity; // optional; 0 leaves /connectivity unavailable
+	SnapshotFollower * follower; // set when the state comes from a SharedSnapshot
+
+	AppContext(NetworkState & state, EventRing & events, DeviceState & devices, JobTable & jobs, int maxEventStreams,
+	           NetworkRefresher * refresher = 0, ConnectionControl * connections = 0, ConnectivityCache * connectivity = 0,
+	           SnapshotFollower * follower = 0):
+	state(state), events(events), devices(devices), jobs(jobs), maxEventStreams(maxEventStreams),
+	refresher(refresher), connections(connections), connectivity(connectivity), follower(follower) {}
+};
+#endif // APP_CONTEXT_H
@@ -1,13 +1,38 @@
 #include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <pthread.h>
 #include <unistd.h>
 
 #include "fcgio.h"
 
 #include <restcgi/endpoint.h>
-#include <restcgi/rest.h>
+#include <restcgi/env.h>
 
 #include "NetworkProxyImpl.h"
 #include "NetworkData.h"
+#include "NetworkState.h"
+#include "EventRing.h"
+#include "DeviceCache.h"
+#include "DeviceTable.h"
+#include "ConnectionJobs.h"
+#include "JobTable.h"
+#include "ConnectivityCache.h"
+#include "SharedSnapshot.h"
+#include "Prefork.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include "TracingRest.h"
+#include "AppContext.h"
 #include "Myroot.h"
 
 using namespace std;
@@ -16,34 +41,112 @@ using namespace org::freedesktop;
 #define FCGI_ONLY 0
 
 DBus::BusDispatcher dispatcher;
+NetworkState networkState;
+EventRing networkEvents;
+DeviceState deviceState;
+JobTable jobTable;
 
-extern "C" {
-     void set_env(char** penv) {
-         char buf[4000];
-         for (; *penv; ++penv) {
-             ::strncpy(buf, *penv, sizeof(buf));
-             buf[sizeof(buf) - 1] = 0; // ensure terminated
-             char* p = ::strchr(buf, '=');
-             const char* v = "";
-             if (p) {*p = 0; v = p + 1;}
-             ::setenv(buf, v, 1); // makes copy of buf, v
-         }
-    }
+// libfcgi wants accepts on a shared listen socket serialized.
+static std::mutex acceptMutex;
+
+// Set from signal handlers: SIGTERM/SIGINT stop (draining first), SIGUSR2
+// asks a prefork master to hand over to a new binary.
+static std::atomic<bool> terminating(false);
+static std::atomic<bool> upgradeRequested(false);
+static std::atomic<int> serving(0); // worker threads still running
+
+static void onTerminate(int) {
+    terminating = true;
 }
 
-int main(void) {
-#if FCGI_ONLY
-    // Backup the stdio streambufs
-    streambuf * cin_streambuf  = cin.rdbuf();
-    streambuf * cout_streambuf = cout.rdbuf();
-    streambuf * cerr_streambuf = cerr.rdbuf();
-#endif
+static void onUpgrade(int) {
+    upgradeRequested = true;
+}
 
-    FCGX_Init();
+// SIGUSR1 only interrupts: sent to the worker blocked in accept() by a drain.
+static void onInterrupt(int) {
+}
+
+// With SA_RESTART a signal sent to the process does not fail the I/O of
+// whichever worker thread happens to take it.
+static void handle(int sig, void (*handler)(int), int flags = SA_RESTART) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handler;
+    sa.sa_flags = flags;
+    sigaction(sig, &sa, 0);
+}
+
+// FCGIAPP_DRAIN_SECONDS (default 30) for requests in progress at SIGTERM.
+static int drainSeconds() {
+    const char * s = getenv("FCGIAPP_DRAIN_SECONDS");
+    return s ? std::max(0, atoi(s)) : 30;
+}
+
+// Every FastCGI process polls the shared listen socket and all of them wake
+// for a connection only one accept() gets; the others stay blocked in
+// accept(). The worker there (one per process, under acceptMutex) is
+// recorded so that a drain can interrupt it with SIGUSR1, which makes
+// FCGX_Accept_r fail with EINTR as requests are initialized with
+// FCGI_FAIL_ACCEPT_ON_INTR. accepterMutex keeps the signal from reaching
+// the worker once it has a connection.
+static std::mutex accepterMutex;
+static bool accepting = false;
+static pthread_t accepter;
+
+static void interruptAccept() {
+    std::lock_guard<std::mutex> lock(accepterMutex);
+    if (accepting)
+        pthread_kill(accepter, SIGUSR1);
+}
+
+// Waits, with the accept lock held, until a connection is pending on the
+// listen socket, so that a drain finds the worker here and not in
+// accept(). False once draining.
+static bool connectionPending() {
+    struct pollfd listener;
+    listener.fd = 0;
+    listener.events = POLLIN;
+    while (!terminating) {
+        listener.revents = 0;
+        if (poll(&listener, 1, 200) > 0)
+            return true;
+    }
+    return false;
+}
+
+// proxy is null in processes that follow a SharedSnapshot.
+static void serve(AppContext & context, NetworkManager_proxyImpl * proxy) {
     FCGX_Request request;
-    FCGX_InitRequest(&request, 0, 0);
+    FCGX_InitRequest(&request, 0, FCGI_FAIL_ACCEPT_ON_INTR);
+
+    for (;;) {
+        int rc;
+        {
+            std::lock_guard<std::mutex> lock(acceptMutex);
+            if (connectionPending()) {
+                Tracer::Span span("accept");
+                {
+                    std::lock_guard<std::mutex> recorded(accepterMutex);
+                    accepting = true;
+                    accepter = pthread_self();
+                }
+                rc = FCGX_Accept_r(&request);
+                std::lock_guard<std::mutex> recorded(accepterMutex);
+                accepting = false;
+            } else {
+                rc = -1;
+            }
+        }
+        if (rc == -EINTR && !terminating)
+            continue;
+        if (rc < 0)
+            break;
+        Metrics::clock::time_point accepted = Metrics::clock::now();
+        Tracer::Request traced;
+        Metrics::Route route = Metrics::OTHER;
+        int status = 0;
 
-    while (FCGX_Accept_r(&request) == 0) {
 #if FCGI_ONLY
         fcgi_streambuf cin_fcgi_streambuf(request.in);
         fcgi_streambuf cout_fcgi_streambuf(request.out);
@@ -54,38 +157,24 @@ int main(void) {
         cerr.rdbuf(&cerr_fcgi_streambuf);
 #endif
 
-        // TODO: Code required refactoring and should be moved from here
-        DBus::default_dispatcher = &dispatcher;
-        DBus::Connection bus = DBus::Connection::SystemBus();
-
-        NetworkManager_proxyImpl proxy(bus, "/org/freedesktop/NetworkManager",
-                                            "org.freedesktop.NetworkManager");
-        bool isNetwokEnabled = false;
-        isNetwokEnabled = proxy.NetworkingEnabled();
+#if FCGI_ONLY
+        // Properties come from the mirror, kept current by PropertiesChanged.
+        org::freedesktop::NetworkManager_mirror nm = proxy->mirror();
+        bool isNetwokEnabled = nm.NetworkingEnabled;
+        bool isWirelessEnabled = nm.WirelessEnabled;
 
-        bool isWirelessEnabled = false;
-        isWirelessEnabled = proxy.WirelessEnabled();
-        
-        std::vector< ::DBus::Path > connections = proxy.ActiveConnections();
+        std::vector< ::DBus::Path > & connections = nm.ActiveConnections;
         std::stringstream ss;
-        for(std::vector< ::DBus::Path >::const_iterator itr = connections.begin();  itr != connections.end(); ++itr) {
-            std::string path = (*itr);
-            ss<<path;
-        }
+        for(std::vector< ::DBus::Path >::const_iterator itr = connections.begin();  itr != connections.end(); ++itr)
+            ss << (itr == connections.begin() ? "" : " ") << *itr;
 
-        std::vector< ::DBus::Path > devices = proxy.GetDevices();
+        // Devices as the refresher last loaded them; workers stay off the bus.
         std::stringstream deviceList;
-        for(std::vector< ::DBus::Path >::const_iterator itr = devices.begin();  itr != devices.end(); ++itr) {
-            std::string path = (*itr);
-            deviceList<<path;
-        }
-       
-        // TODO: Create the Proxy for "org.freedesktop.NetworkManager.Device" using object path from above
-        // TODO: Fetch org.freedesktop.NetworkManager.Device.Ip4Config which gives object path
-        // for org.freedesktop.NetworkManager.Ip4Config and create a proxy for 'org.freedesktop.NetworkManager.Ip4Config' interface
-        // org.freedesktop.NetworkManager.Ip4Config.AddressData and Gateway gives required data.
-
-        // TODO: Remove the hardcoded values once the above steps are done
+        DeviceState::Reader deviceReader(deviceState);
+        if (const DeviceTable * table = deviceReader.table())
+            for(DeviceTable::map_type::const_iterator itr = table->devices().begin();  itr != table->devices().end(); ++itr)
+                deviceList << (itr == table->devices().begin() ? "" : " ") << itr->second->path;
+#endif
 
 #if FCGI_ONLY
     if (isNetwokEnabled)    {
@@ -122,19 +211,386 @@ int main(void) {
          }
 #endif
         //REST
-        fcgi_streambuf fisbuf(request.in);
-        std::istream is(&fisbuf);
-        fcgi_streambuf fosbuf(request.out);
-        std::ostream os(&fosbuf);
-        set_env(request.envp);
-
-         // restcgi processing. 
-        restcgi::endpoint::method_pointer m = restcgi::endpoint::create(is, os)->receive();
-        restcgi::resource::pointer root(new Myroot( restcgi::method_e::GET));
-        restcgi::rest().process(m, root);
-
-        // Note: the fcgi_streambuf destructor will auto flush
+        {
+            Tracer::Span span("request");
+            Tracer::Span setup("env");
+            fcgi_streambuf fisbuf(request.in);
+            std::istream is(&fisbuf);
+            fcgi_streambuf fosbuf(request.out);
+            std::ostream os(&fosbuf);
+            // Per-request environment; setenv() would race between workers.
+            restcgi::env e(const_cast<const char**>(request.envp));
+            setup.end();
+            Tracer::Span receive("receive");
+
+            // restcgi processing. 
+            restcgi::endpoint::method_pointer m = restcgi::endpoint::create(e, is, os)->receive();
+            receive.end();
+            route = m->uri_path().empty() ? Metrics::ROOT : Metrics::route(m->uri_path().front());
+            Metrics::instance().started(route);
+            restcgi::resource::pointer root(new Myroot(restcgi::method_e::GET | restcgi::method_e::HEAD, context));
+            TracingRest().process(m, root);
+            if (m->responded())
+                status = m->status_code();
+
+            // Note: the fcgi_streambuf destructor will auto flush
+        }
+        {
+            Tracer::Span span("finish");
+            FCGX_Finish_r(&request);
+        }
+        Metrics::instance().finished(route, status, Metrics::clock::now() - accepted);
+    }
+    --serving;
+}
+
+// What the REST resources serve, read from NetworkManager. Runs on the
+// refresher thread; a timeout or error surfaces as DBus::Error.
+//
+// The root document describes the first device, in interface order, that
+// has an IPv4 address.
+static NetworkData fetchNetworkData(NetworkManager_proxyImpl & proxy, DeviceCache & devices) {
+    proxy.refresh();
+    devices.sync(proxy.devices());
+
+    DeviceState::Reader reader(deviceState);
+    const DeviceTable::map_type & table = reader.table()->devices();
+    for (DeviceTable::map_type::const_iterator itr = table.begin(); itr != table.end(); ++itr) {
+        const Ip4Config & ip4 = itr->second->ip4config;
+        if (!ip4.addresses.empty())
+            return NetworkData(ip4.addresses.front(), ip4.addresses.front().mask(), ip4.gateway);
+    }
+    return NetworkData(IpAddress(), IpAddress(), IpAddress());
+}
+
+// CheckConnectivity makes NetworkManager probe the network, which takes
+// far longer than the usual call deadline; it gets its own. Where the call
+// is refused (connectivity checking disabled, or not permitted) the last
+// verdict NetworkManager announced is used instead; any other error, such
+// as no NetworkManager on the bus or no reply, is the caller's.
+static bool connectivityRefused(const DBus::Error & e) {
+    static const char * const refusals[] = {
+        "org.freedesktop.DBus.Error.AccessDenied",
+        "org.freedesktop.DBus.Error.NotSupported",
+        "org.freedesktop.NetworkManager.PermissionDenied", // polkit said no
+        0
+    };
+    for (const char * const * name = refusals; e.name() && *name; ++name)
+        if (!strcmp(e.name(), *name))
+            return true;
+    return false;
+}
+
+static uint32_t checkConnectivity(DBus::Connection & bus, NetworkManager_proxyImpl & proxy, int timeoutMs) {
+    DBus::CallMessage call("org.freedesktop.NetworkManager", "/org/freedesktop/NetworkManager",
+                           "org.freedesktop.NetworkManager", "CheckConnectivity");
+    try {
+        Metrics::DBusTimer timer(Metrics::CHECK_CONNECTIVITY);
+        DBus::Message reply = bus.send_blocking(call, timeoutMs);
+        uint32_t state;
+        DBus::MessageIter ri = reply.reader();
+        ri >> state;
+        return state;
+    } catch (const DBus::Error & e) {
+        if (!connectivityRefused(e))
+            throw;
+        return proxy.mirror().Connectivity;
+    }
+}
+
+// FCGIAPP_BUS selects where NetworkManager is looked up: "system" (the
+// default), "session", or a bus address such as that of a private
+// dbus-daemon running mock/mocknm.
+static DBus::Connection openBus() {
+    const char * bus = getenv("FCGIAPP_BUS");
+    if (!bus || !strcmp(bus, "system"))
+        return DBus::Connection::SystemBus();
+    if (!strcmp(bus, "session"))
+        return DBus::Connection::SessionBus();
+    DBus::Connection connection(bus);
+    connection.register_bus();
+    return connection;
+}
+
+// Starts the request workers and returns once they have all stopped. On
+// SIGTERM they drain: nothing new is accepted, event streams are ended and
+// the requests in progress get drainSeconds() to finish. The listen socket
+// stays open meanwhile, so whatever is queued on it goes to the processes
+// that keep serving. Idle workers stop at once, the one in accept() too;
+// only requests that outlast the drain are cut off.
+static void serveAll(AppContext & context, NetworkManager_proxyImpl * proxy, int threads) {
+    handle(SIGTERM, onTerminate);
+    handle(SIGINT, onTerminate);
+    handle(SIGUSR1, onInterrupt, 0);
+    FCGX_Init();
+    serving = threads;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i)
+        workers.push_back(std::thread(serve, std::ref(context), proxy));
+    while (serving > 0 && !terminating)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (terminating) {
+        context.events.close();
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(drainSeconds());
+        while (serving > 0 && std::chrono::steady_clock::now() < deadline) {
+            interruptAccept(); // again, in case it had not reached accept() yet
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (serving > 0) {
+            cerr << "drain timed out with " << serving << " requests in progress\n";
+            _exit(0);
+        }
     }
+    for (size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+}
+
+// A FastCGI process that serves what the updater process writes to the
+// segment at path, without a D-Bus connection of its own. Resources that
+// have to call NetworkManager (/connections, /connectivity) answer 503.
+static int follow(const char * path, int threads) {
+    std::unique_ptr<SharedSnapshot> segment;
+    for (bool told = false; !segment; ) {
+        try {
+            segment.reset(new SharedSnapshot(path, false));
+        } catch (const std::runtime_error & e) {
+            if (!told)
+                cerr << e.what() << ", waiting for the updater\n";
+            told = true;
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    }
+    SnapshotFollower follower(*segment, networkState, deviceState, &networkEvents);
+    follower.poll();
+    follower.start();
+    AppContext context(networkState, networkEvents, deviceState, jobTable, threads - 1, 0, 0, 0, &follower);
+    serveAll(context, 0, threads);
+    follower.stop();
+    networkEvents.close();
+    return 0;
+}
+
+// Passed to the binary that takes over from a prefork master.
+struct Handover {
+    std::string executable; // as started, so a binary replaced on disk is picked up
+    int listenFd;
+    pid_t predecessor;      // the master this one replaces, 0 if none
+};
+
+static std::vector<std::string> environmentWithout(const char * const * dropped) {
+    std::vector<std::string> env;
+    for (char ** e = environ; *e; ++e) {
+        bool drop = false;
+        for (const char * const * d = dropped; *d && !drop; ++d)
+            drop = !strncmp(*e, *d, strlen(*d));
+        if (!drop)
+            env.push_back(*e);
+    }
+    return env;
+}
+
+// Starts the new binary on the same listen socket. It takes over once its
+// own workers are up, by sending this master SIGTERM.
+static void startSuccessor(const Handover & handover) {
+    static const char * const dropped[] = { "FCGIAPP_LISTEN=", "FCGIAPP_LISTEN_FD=", "FCGIAPP_UPGRADE_FROM=", 0 };
+    std::vector<std::string> env = environmentWithout(dropped);
+    env.push_back("FCGIAPP_LISTEN_FD=" + std::to_string(handover.listenFd));
+    env.push_back("FCGIAPP_UPGRADE_FROM=" + std::to_string(getpid()));
+    pid_t pid = Prefork::launch(handover.executable, std::vector<std::string>(), env, handover.listenFd, false);
+    if (pid < 0)
+        cerr << "upgrade: cannot start " << handover.executable << ": " << strerror(errno) << "\n";
+    else
+        cerr << "upgrade: started " << handover.executable << " as " << pid << "\n";
+}
+
+// The one process on the bus when FastCGI processes follow a segment: it
+// keeps the segment current and serves nothing itself. As a prefork
+// master it also starts the workers, once the segment has something in
+// it, and restarts them when they exit. Returns on SIGTERM or SIGINT,
+// after the workers have drained.
+//
+// SIGUSR2 makes a master start its successor (see startSuccessor()); a
+// successor retires its predecessor once all its workers are running.
+static int update(const char * path, NetworkRefresher & refresher, Prefork * workers, Handover * handover) {
+    handle(SIGTERM, onTerminate);
+    handle(SIGINT, onTerminate);
+    if (handover)
+        handle(SIGUSR2, onUpgrade);
+
+    SharedSnapshot segment(path, true);
+    SnapshotPublisher publisher(segment, networkState, deviceState);
+    publisher.publish(refresher.freshness());
+    if (workers)
+        workers->start();
+    while (!terminating) {
+        refresher.touch();
+        publisher.publish(refresher.freshness());
+        if (workers && workers->reap())
+            cerr << "restarted a worker, " << workers->restarts() << " so far\n";
+        if (handover && upgradeRequested.exchange(false))
+            startSuccessor(*handover);
+        if (handover && handover->predecessor && workers->settled()) {
+            kill(handover->predecessor, SIGTERM);
+            handover->predecessor = 0;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    if (workers)
+        workers->stop(SIGTERM, std::chrono::seconds(drainSeconds() + 5));
+    return 0;
+}
+
+// The environment of prefork workers: this one, following the master's
+// segment instead of doing the master's job.
+static std::vector<std::string> workerEnvironment(const std::string & shm) {
+    static const char * const dropped[] = { "FCGIAPP_WORKERS=", "FCGIAPP_LISTEN=", "FCGIAPP_LISTEN_FD=", "FCGIAPP_UPGRADE_FROM=",
+                                            "FCGIAPP_SHM=", "FCGIAPP_SHM_UPDATER=", 0 };
+    std::vector<std::string> env = environmentWithout(dropped);
+    env.push_back("FCGIAPP_SHM=" + shm);
+    return env;
+}
+
+static std::string executable() {
+    char path[4096];
+    ssize_t n = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (n < 0)
+        throw std::runtime_error(std::string("/proc/self/exe: ") + strerror(errno));
+    return std::string(path, n);
+}
+
+int main(void) {
+#if FCGI_ONLY
+    // Backup the stdio streambufs
+    streambuf * cin_streambuf  = cin.rdbuf();
+    streambuf * cout_streambuf = cout.rdbuf();
+    streambuf * cerr_streambuf = cerr.rdbuf();
+#endif
+
+    // Event streams hold their request open, so requests are served by a
+    // pool of worker threads (FCGIAPP_THREADS, default 4) instead of one
+    // accept loop. One worker is always kept free of event streams.
+    int threads = 4;
+    if (const char * s = getenv("FCGIAPP_THREADS"))
+        threads = std::max(2, atoi(s));
+
+    // FCGIAPP_TRACE=1 keeps the Tracer on; otherwise GET /trace?seconds=N
+    // turns it on for a while.
+    if (const char * s = getenv("FCGIAPP_TRACE"))
+        if (!strcmp(s, "1"))
+            Tracer::instance().enable();
+
+    // With FCGIAPP_SHM set, one process (FCGIAPP_SHM_UPDATER=1) talks to
+    // NetworkManager and writes the state to that file; every FastCGI
+    // process maps it, so the load on NetworkManager does not grow with
+    // spawn-fcgi -F.
+    //
+    // FCGIAPP_WORKERS=N makes this process such an updater and the master
+    // of N worker processes of its own, each pinned to a CPU, serving
+    // FCGIAPP_LISTEN (e.g. ":8000") or the socket spawn-fcgi passed in.
+    // Each master has a segment of its own, FCGIAPP_SHM (default
+    // /dev/shm/fcgiapp) with its pid appended, so that an upgrade can run
+    // two side by side.
+    const char * shm = getenv("FCGIAPP_SHM");
+    const char * updater = getenv("FCGIAPP_SHM_UPDATER");
+    const char * prefork = getenv("FCGIAPP_WORKERS");
+    bool updating = shm && updater && atoi(updater);
+    std::unique_ptr<Prefork> workers;
+    std::unique_ptr<Handover> handover;
+    std::string segmentPath;
+    if (prefork && atoi(prefork) > 0) {
+        int listenFd = 0;
+        if (const char * fd = getenv("FCGIAPP_LISTEN_FD")) {
+            listenFd = atoi(fd); // inherited from the master this one replaces
+        } else if (const char * listen = getenv("FCGIAPP_LISTEN")) {
+            FCGX_Init();
+            listenFd = FCGX_OpenSocket(listen, 1024);
+            if (listenFd < 0) {
+                cerr << listen << ": cannot listen\n";
+                return 1;
+            }
+        }
+        segmentPath = std::string(shm ? shm : "/dev/shm/fcgiapp") + "." + std::to_string(getpid());
+        shm = segmentPath.c_str();
+        updating = true;
+        const char * pin = getenv("FCGIAPP_PIN");
+        const char * predecessor = getenv("FCGIAPP_UPGRADE_FROM");
+        handover.reset(new Handover());
+        handover->executable = executable();
+        handover->listenFd = listenFd;
+        handover->predecessor = predecessor ? atoi(predecessor) : 0;
+        workers.reset(new Prefork(handover->executable, std::vector<std::string>(), workerEnvironment(segmentPath),
+                                  listenFd, atoi(prefork), !pin || atoi(pin)));
+    }
+    if (shm && !updating)
+        return follow(shm, threads);
+
+    DBus::_init_threading();
+    DBus::default_dispatcher = &dispatcher;
+    DBus::Connection bus = openBus();
+
+    // Long-lived so that its signal handlers can feed the event ring.
+    NetworkManager_proxyImpl proxy(bus, "/org/freedesktop/NetworkManager",
+                                        "org.freedesktop.NetworkManager", &networkEvents);
+
+    // Every call to NetworkManager has a deadline (FCGIAPP_DBUS_TIMEOUT_MS,
+    // default 250) instead of the library default of 25 seconds, and goes
+    // through a breaker so a hung NetworkManager is not hammered. Requests
+    // are served from the last good snapshot meanwhile.
+    int timeoutMs = 250;
+    if (const char * s = getenv("FCGIAPP_DBUS_TIMEOUT_MS"))
+        timeoutMs = std::max(1, atoi(s));
+    proxy.set_timeout(timeoutMs);
+    DeviceCache devices(bus, deviceState, timeoutMs);
+    CircuitBreaker breaker(3, std::chrono::seconds(5));
+    NetworkRefresher refresher(networkState,
+                               [&proxy, &devices] { return fetchNetworkData(proxy, devices); }, breaker);
+    if (!refresher.refresh())
+        cerr << "NetworkManager not answering, serving stale data until it does\n";
+    refresher.start();
+
+    // Signals are dispatched on a thread of their own, so the mirror, the
+    // event ring and the refresher follow NetworkManager without any
+    // request worker waiting on the bus.
+    proxy.onChange([&refresher] { refresher.invalidate(); });
+    std::thread dispatch([] { dispatcher.enter(); });
+    if (updating) {
+        int rc = update(shm, refresher, workers.get(), handover.get());
+        if (workers)
+            unlink(shm);
+        dispatcher.leave();
+        dispatch.join();
+        refresher.stop();
+        return rc;
+    }
+
+    // Connection (de)activations are queued by the workers and carried out
+    // on a thread of their own, with FCGIAPP_ACTIVATE_TIMEOUT_MS (default
+    // 30000) per call. They change the host's network, so POST and DELETE
+    // /connections exist only with FCGIAPP_CONNECTION_CONTROL=1.
+    int activateTimeoutMs = 30000;
+    if (const char * s = getenv("FCGIAPP_ACTIVATE_TIMEOUT_MS"))
+        activateTimeoutMs = std::max(1, atoi(s));
+    const char * control = getenv("FCGIAPP_CONNECTION_CONTROL");
+    ConnectionJobs connections(bus, dispatcher, jobTable, activateTimeoutMs);
+    connections.start();
+
+    // FCGIAPP_CONNECTIVITY_TTL seconds (default 30) between checks.
+    int connectivityTtl = 30;
+    if (const char * s = getenv("FCGIAPP_CONNECTIVITY_TTL"))
+        connectivityTtl = std::max(1, atoi(s));
+    ConnectivityCache connectivity([&bus, &proxy] { return checkConnectivity(bus, proxy, 10000); },
+                                   std::chrono::seconds(connectivityTtl));
+    connectivity.start();
+    AppContext context(networkState, networkEvents, deviceState, jobTable, threads - 1,
+                       &refresher, control && atoi(control) ? &connections : 0, &connectivity);
+
+    serveAll(context, &proxy, threads);
+    connectivity.stop();
+    connections.stop();
+    dispatcher.leave();
+    dispatch.join();
+    refresher.stop();
+    networkEvents.close();
 
 #if FCGI_ONLY
     // restore stdio streambufs
@@ -143,4 +599,4 @@ int main(void) {
     cerr.rdbuf(cerr_streambuf);*/
 #endif
     return 0;
-}
\ No newline at end of file
+}
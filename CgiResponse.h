@@ -0,0 +1,96 @@
+#ifndef CGI_RESPONSE_H
+#define CGI_RESPONSE_H
+
+#include <cstdlib>
+#include <string>
+
+#include "JsonText.h"
+
+// A CGI response as restcgi writes it ("Status: 200 OK\r\nName: value\r\n
+// \r\nbody"), split up again; Mybatch embeds its sub-responses this way.
+struct CgiResponse {
+	int status;
+	std::string etag;
+	std::string contentType;
+	std::string body;
+
+	CgiResponse(): status(200) {}
+
+	// Without the blank line everything is taken as headers.
+	static CgiResponse parse(const std::string & cgi) {
+		CgiResponse rsp;
+		std::string::size_type end = cgi.find("\r\n\r\n");
+		std::string::size_type headers = end == std::string::npos ? cgi.size() : end;
+		std::string::size_type begin = 0;
+		while (begin < headers) {
+			std::string::size_type eol = cgi.find("\r\n", begin);
+			if (eol == std::string::npos || eol > headers)
+				eol = headers;
+			std::string line = cgi.substr(begin, eol - begin);
+			std::string::size_type colon = line.find(':');
+			std::string name = line.substr(0, colon);
+			std::string::size_type value = colon == std::string::npos ? std::string::npos : line.find_first_not_of(' ', colon + 1);
+			if (value != std::string::npos) {
+				if (name == "Status")
+					rsp.status = atoi(line.c_str() + value);
+				else if (name == "ETag")
+					rsp.etag = line.substr(value);
+				else if (name == "Content-Type")
+					rsp.contentType = line.substr(value);
+			}
+			begin = eol + 2;
+		}
+		if (end != std::string::npos)
+			rsp.body = cgi.substr(end + 4);
+		return rsp;
+	}
+
+	// Appends {"path": ..., "status": ..., "etag": ..., "body": ...} to out.
+	// A JSON body is embedded as is, text as a string and anything else,
+	// such as the binary representation, base64-encoded as bodyBase64.
+	void appendJson(std::string & out, const std::string & path) const {
+		out += "{\"path\": ";
+		appendJsonString(out, path);
+		out += ", \"status\": " + std::to_string(status);
+		if (!etag.empty()) {
+			out += ", \"etag\": ";
+			appendJsonString(out, etag);
+		}
+		if (!body.empty()) {
+			if (contentType.compare(0, 16, "application/json") == 0) {
+				out += ", \"body\": ";
+				out += body;
+			} else if (contentType.empty() || contentType.compare(0, 5, "text/") == 0) {
+				out += ", \"body\": ";
+				appendJsonString(out, body);
+			} else {
+				out += ", \"bodyBase64\": \"";
+				appendBase64(out, body);
+				out += '"';
+			}
+		}
+		out += "}";
+	}
+
+	static void appendBase64(std::string & out, const std::string & data) {
+		static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		size_t i = 0;
+		for (; i + 2 < data.size(); i += 3) {
+			unsigned n = static_cast<unsigned char>(data[i]) << 16 | static_cast<unsigned char>(data[i + 1]) << 8 | static_cast<unsigned char>(data[i + 2]);
+			out += digits[n >> 18];
+			out += digits[n >> 12 & 63];
+			out += digits[n >> 6 & 63];
+			out += digits[n & 63];
+		}
+		if (i < data.size()) {
+			unsigned n = static_cast<unsigned char>(data[i]) << 16;
+			if (i + 1 < data.size())
+				n |= static_cast<unsigned char>(data[i + 1]) << 8;
+			out += digits[n >> 18];
+			out += digits[n >> 12 & 63];
+			out += i + 1 < data.size() ? digits[n >> 6 & 63] : '=';
+			out += '=';
+		}
+	}
+};
+#endif // CGI_RESPONSE_H
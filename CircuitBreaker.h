@@ -0,0 +1,62 @@
+#ifndef CIRCUIT_BREAKER_H
+#define CIRCUIT_BREAKER_H
+
+#include <chrono>
+#include <mutex>
+
+// Stops calling a dependency that keeps failing. After failureThreshold
+// consecutive failures the breaker opens and allow() refuses calls; once
+// openFor has passed it lets a single probe through (half-open), which
+// closes it again on success or reopens it on failure.
+class CircuitBreaker {
+public:
+	typedef std::chrono::steady_clock clock;
+	enum State { CLOSED, OPEN, HALF_OPEN };
+
+	CircuitBreaker(unsigned failureThreshold = 3, clock::duration openFor = std::chrono::seconds(5)):
+	failureThreshold_(failureThreshold ? failureThreshold : 1), openFor_(openFor), state_(CLOSED), failures_(0) {}
+
+	// Whether a call may go ahead now.
+	bool allow(clock::time_point now = clock::now()) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		switch (state_) {
+		case CLOSED:
+			return true;
+		case OPEN:
+			if (now - openedAt_ < openFor_)
+				return false;
+			state_ = HALF_OPEN;
+			return true;
+		default:
+			return false; // a probe is already out
+		}
+	}
+
+	void success() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		state_ = CLOSED;
+		failures_ = 0;
+	}
+
+	void failure(clock::time_point now = clock::now()) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (state_ == HALF_OPEN || ++failures_ >= failureThreshold_) {
+			state_ = OPEN;
+			openedAt_ = now;
+		}
+	}
+
+	State state() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return state_;
+	}
+
+private:
+	mutable std::mutex mutex_;
+	const unsigned failureThreshold_;
+	const clock::duration openFor_;
+	State state_;
+	unsigned failures_;
+	clock::time_point openedAt_;
+};
+#endif // CIRCUIT_BREAKER_H
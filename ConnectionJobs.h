@@ -0,0 +1,247 @@
+#ifndef CONNECTION_JOBS_H
+#define CONNECTION_JOBS_H
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <dbus-c++/dbus.h>
+
+#include "ActiveConnectionProxy.h"
+#include "JobTable.h"
+#include "Metrics.h"
+
+// Runs connection (de)activations for the REST resources. Request workers
+// only queue the operation and get a job id back; the D-Bus call is made
+// on the job thread, and the job then follows the ActiveConnection's
+// StateChanged signals, delivered on the dispatcher thread. Activation can
+// take seconds, but none of it is spent on a worker.
+//
+// NetworkManager answers these calls only after polkit and, for
+// AddAndActivateConnection, the settings write, so they get a deadline of
+// their own (timeoutMs) rather than the shared proxy's.
+class ConnectionJobs : public ConnectionControl {
+public:
+	ConnectionJobs(DBus::Connection & connection, DBus::DefaultMainLoop & dispatcher, JobTable & jobs,
+	               int timeoutMs = 30000, const char * service = "org.freedesktop.NetworkManager"):
+	connection_(connection), jobs_(jobs), timeoutMs_(timeoutMs), service_(service), stopping_(false),
+	reaper_(1000, true, &dispatcher) {
+		reaper_.expired = new DBus::Callback<ConnectionJobs, void, DBus::DefaultTimeout &>(this, &ConnectionJobs::reap);
+	}
+
+	~ConnectionJobs() { stop(); }
+
+	void start() {
+		worker_ = std::thread(&ConnectionJobs::run, this);
+	}
+
+	// Jobs still queued are failed, so that nobody polls them forever.
+	void stop() {
+		std::deque<task_type> dropped;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+			dropped.swap(tasks_);
+		}
+		wake_.notify_one();
+		if (worker_.joinable())
+			worker_.join();
+		for (std::deque<task_type>::const_iterator itr = dropped.begin(); itr != dropped.end(); ++itr)
+			jobs_.failed(itr->first, "service stopping");
+	}
+
+	uint64_t activate(const std::string & connection, const std::string & device, const std::string & specificObject) {
+		uint64_t id = jobs_.create("activate");
+		queue(id, [=] {
+			::DBus::CallMessage call = request("ActivateConnection");
+			::DBus::MessageIter wi = call.writer();
+			wi << ::DBus::Path(connection);
+			wi << ::DBus::Path(orRoot(device));
+			wi << ::DBus::Path(orRoot(specificObject));
+			::DBus::Path active;
+			{
+				Metrics::DBusTimer timer(Metrics::ACTIVATE_CONNECTION);
+				::DBus::Message reply = connection_.send_blocking(call, timeoutMs_);
+				::DBus::MessageIter ri = reply.reader();
+				ri >> active;
+			}
+			started(id, active);
+		});
+		return id;
+	}
+
+	uint64_t addAndActivate(const settings_type & settings, const std::string & device, const std::string & specificObject) {
+		uint64_t id = jobs_.create("add-and-activate");
+		queue(id, [=] {
+			std::map< std::string, std::map< std::string, ::DBus::Variant > > connection;
+			for (settings_type::const_iterator group = settings.begin(); group != settings.end(); ++group)
+				for (std::map<std::string, std::string>::const_iterator itr = group->second.begin(); itr != group->second.end(); ++itr)
+					connection[group->first][itr->first] = variant(itr->second);
+			::DBus::CallMessage call = request("AddAndActivateConnection");
+			::DBus::MessageIter wi = call.writer();
+			wi << connection;
+			wi << ::DBus::Path(orRoot(device));
+			wi << ::DBus::Path(orRoot(specificObject));
+			::DBus::Path path, active;
+			{
+				Metrics::DBusTimer timer(Metrics::ADD_AND_ACTIVATE_CONNECTION);
+				::DBus::Message reply = connection_.send_blocking(call, timeoutMs_);
+				::DBus::MessageIter ri = reply.reader();
+				ri >> path;
+				ri >> active;
+			}
+			started(id, active);
+		});
+		return id;
+	}
+
+	uint64_t deactivate(const std::string & activeConnection) {
+		uint64_t id = jobs_.create("deactivate", activeConnection);
+		queue(id, [=] {
+			watch(activeConnection); // before the call, so no signal is missed
+			::DBus::CallMessage call = request("DeactivateConnection");
+			::DBus::MessageIter wi = call.writer();
+			wi << ::DBus::Path(activeConnection);
+			{
+				Metrics::DBusTimer timer(Metrics::DEACTIVATE_CONNECTION);
+				connection_.send_blocking(call, timeoutMs_);
+			}
+			started(id, activeConnection);
+		});
+		return id;
+	}
+
+private:
+	typedef std::pair<uint64_t, std::function<void()> > task_type;
+
+	// Follows one ActiveConnection for as long as a job needs it.
+	class Watch : public org::freedesktop::NetworkManager::Connection::Active_proxy,
+				public DBus::ObjectProxy
+	{
+	public:
+		Watch(DBus::Connection & connection, const std::string & path, const char * service, JobTable & jobs):
+		DBus::ObjectProxy(connection, path, service), path_(path), jobs_(jobs) {}
+
+		// NetworkManager 1.8 and later.
+		void StateChanged(const uint32_t& state, const uint32_t& reason) {
+			jobs_.activeState(path_, state, reason);
+		}
+
+		// Older releases only announce State as a property change.
+		void PropertiesChanged(const std::map< std::string, ::DBus::Variant >& properties) {
+			std::map< std::string, ::DBus::Variant >::const_iterator itr = properties.find("State");
+			if (itr != properties.end()) {
+				uint32_t state = itr->second;
+				jobs_.activeState(path_, state);
+			}
+		}
+
+	private:
+		std::string path_;
+		JobTable & jobs_;
+	};
+
+	void queue(uint64_t id, std::function<void()> call) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (!stopping_) {
+				tasks_.push_back(task_type(id, call));
+				wake_.notify_one();
+				return;
+			}
+		}
+		jobs_.failed(id, "service stopping");
+	}
+
+	void run() {
+		for (;;) {
+			task_type task;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				wake_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+				if (stopping_)
+					return;
+				task = tasks_.front();
+				tasks_.pop_front();
+			}
+			jobs_.running(task.first);
+			try {
+				task.second();
+			} catch (const DBus::Error & e) {
+				jobs_.failed(task.first, e.message() ? e.message() : "D-Bus call failed");
+			} catch (const std::exception & e) {
+				jobs_.failed(task.first, e.what());
+			}
+		}
+	}
+
+	// Job thread: subscribe to activeConnection's signals, then read its
+	// state once in case it changed before the subscription.
+	void started(uint64_t id, const std::string & activeConnection) {
+		jobs_.started(id, activeConnection);
+		std::shared_ptr<Watch> w = watch(activeConnection);
+		try {
+			jobs_.activeState(activeConnection, w->State());
+		} catch (const DBus::Error &) {
+			// Already gone: fully deactivated.
+			jobs_.activeState(activeConnection, JobTable::DEACTIVATED);
+		}
+	}
+
+	std::shared_ptr<Watch> watch(const std::string & activeConnection) {
+		std::lock_guard<std::mutex> lock(watchMutex_);
+		std::shared_ptr<Watch> & w = watches_[activeConnection];
+		if (!w)
+			w.reset(new Watch(connection_, activeConnection, service_, jobs_));
+		return w;
+	}
+
+	// Dispatcher thread, between dispatches: the only place a proxy can be
+	// destroyed without its filter possibly running meanwhile. One the job
+	// thread still holds is left for next time.
+	void reap(DBus::DefaultTimeout &) {
+		std::lock_guard<std::mutex> lock(watchMutex_);
+		for (std::map<std::string, std::shared_ptr<Watch> >::iterator itr = watches_.begin(); itr != watches_.end(); ) {
+			if (itr->second.use_count() > 1 || jobs_.watched(itr->first))
+				++itr;
+			else
+				watches_.erase(itr++);
+		}
+	}
+
+	::DBus::CallMessage request(const char * member) const {
+		return ::DBus::CallMessage(service_, "/org/freedesktop/NetworkManager", "org.freedesktop.NetworkManager", member);
+	}
+
+	static std::string orRoot(const std::string & path) {
+		return path.empty() ? std::string("/") : path;
+	}
+
+	static ::DBus::Variant variant(const std::string & value) {
+		::DBus::Variant v;
+		::DBus::MessageIter vi = v.writer();
+		vi << value;
+		return v;
+	}
+
+	DBus::Connection & connection_;
+	JobTable & jobs_;
+	const int timeoutMs_;
+	const char * service_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::deque<task_type> tasks_;
+	bool stopping_;
+	std::thread worker_;
+	std::mutex watchMutex_;
+	std::map<std::string, std::shared_ptr<Watch> > watches_; // by object path
+	DBus::DefaultTimeout reaper_;
+};
+#endif // CONNECTION_JOBS_H
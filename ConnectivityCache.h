@@ -0,0 +1,111 @@
+#ifndef CONNECTIVITY_CACHE_H
+#define CONNECTIVITY_CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <stdint.h>
+
+// NetworkManager's connectivity verdict, cached for ttl. check() may make
+// NetworkManager probe the network and take seconds, so it only ever runs
+// on the cache's own thread: a request reads the cached value and, once it
+// is older than ttl, wakes the thread. However many requests see it stale,
+// one check runs at a time.
+class ConnectivityCache {
+public:
+	typedef std::function<uint32_t()> check_type;
+
+	// NM_CONNECTIVITY_*
+	enum { UNKNOWN = 0, NONE = 1, PORTAL = 2, LIMITED = 3, FULL = 4 };
+
+	struct Result {
+		uint32_t state;
+		time_t checked; // 0 until the first check succeeds
+	};
+
+	ConnectivityCache(check_type check, std::chrono::seconds ttl = std::chrono::seconds(30)):
+	check_(check), ttl_(ttl), result_(0), lastAttempt_(0), pending_(false), stopping_(false) {}
+
+	~ConnectivityCache() { stop(); }
+
+	void start() {
+		worker_ = std::thread(&ConnectivityCache::run, this);
+	}
+
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		wake_.notify_one();
+		if (worker_.joinable())
+			worker_.join();
+	}
+
+	// Request path: one atomic load, plus a wake-up when stale.
+	Result get(time_t now = time(0)) {
+		Result r = unpack(result_.load(std::memory_order_acquire));
+		bool stale = r.checked == 0 || now - r.checked >= ttl_.count();
+		// At most one attempt a second while checks keep failing.
+		if (stale && now != lastAttempt_.load(std::memory_order_relaxed) && !pending_.exchange(true)) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			wake_.notify_one();
+		}
+		return r;
+	}
+
+	// One check on the calling thread. A failed check keeps the old
+	// result, which goes on being served (and re-checked) as stale.
+	bool refresh(time_t now = time(0)) {
+		lastAttempt_.store(now, std::memory_order_relaxed);
+		try {
+			uint32_t state = check_();
+			result_.store(pack(state, now), std::memory_order_release);
+			return true;
+		} catch (const std::exception &) {
+			return false;
+		}
+	}
+
+	std::chrono::seconds ttl() const { return ttl_; }
+
+	static const char * name(uint32_t state) {
+		static const char * const names[] = { "unknown", "none", "portal", "limited", "full" };
+		return state <= FULL ? names[state] : "unknown";
+	}
+
+private:
+	// checked in the high 32 bits, state in the low ones.
+	static uint64_t pack(uint32_t state, time_t checked) { return uint64_t(uint32_t(checked)) << 32 | state; }
+	static Result unpack(uint64_t v) { Result r = { uint32_t(v), time_t(v >> 32) }; return r; }
+
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		for (;;) {
+			if (!wake_.wait_for(lock, std::chrono::seconds(1), [this] { return stopping_ || pending_.load(); }))
+				continue;
+			if (stopping_)
+				return;
+			lock.unlock();
+			refresh();
+			pending_ = false;
+			lock.lock();
+		}
+	}
+
+	check_type check_;
+	const std::chrono::seconds ttl_;
+	std::atomic<uint64_t> result_;
+	std::atomic<time_t> lastAttempt_;
+	std::atomic<bool> pending_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	bool stopping_;
+	std::thread worker_;
+};
+#endif // CONNECTIVITY_CACHE_H
@@ -0,0 +1,188 @@
+#ifndef DEVICE_CACHE_H
+#define DEVICE_CACHE_H
+
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <dbus-c++/dbus.h>
+
+#include "DeviceMirror.h"
+#include "DeviceTable.h"
+#include "Metrics.h"
+#include "PathTable.h"
+
+// Per-device Device and IP4Config properties, kept by object path and
+// published to a DeviceState. sync() runs on the refresher thread with the
+// current GetDevices result: vanished devices are dropped, and at most
+// loadBudget devices are loaded, new ones first, then known ones older
+// than reloadAge. One refresh stays bounded however many devices there
+// are; a long device list fills in over several.
+//
+// The calls go out on the shared connection addressed by object path
+// rather than through one dbus-c++ ObjectProxy per device: every
+// ObjectProxy adds a match rule on the bus, and the system bus caps those
+// per connection well below the device counts this has to handle.
+class DeviceCache {
+public:
+	DeviceCache(DBus::Connection & connection, DeviceState & state, int timeoutMs,
+	            const char * service = "org.freedesktop.NetworkManager",
+	            size_t loadBudget = 64, time_t reloadAge = 30):
+	connection_(connection), state_(state), timeoutMs_(timeoutMs), service_(service),
+	loadBudget_(loadBudget), reloadAge_(reloadAge) {}
+
+	// Throws DBus::Error when NetworkManager does not answer in time, after
+	// publishing what was loaded until then; a device that fails otherwise
+	// (e.g. removed meanwhile) is skipped.
+	void sync(const std::vector<PathId> & paths, time_t now = time(0)) {
+		PathTable & table = PathTable::instance();
+		std::map<PathId, Entry> entries;
+		std::vector<PathId> stale;
+		size_t loads = 0;
+		std::exception_ptr timeout;
+		for (std::vector<PathId>::const_iterator itr = paths.begin(); itr != paths.end(); ++itr) {
+			std::map<PathId, Entry>::iterator known = entries_.find(*itr);
+			if (known != entries_.end()) {
+				entries[*itr] = known->second;
+				if (now - known->second.loaded < reloadAge_)
+					Metrics::instance().cache(Metrics::DEVICE_CACHE, true);
+				else
+					stale.push_back(*itr);
+				continue;
+			}
+			Metrics::instance().cache(Metrics::DEVICE_CACHE, false);
+			if (timeout || loads >= loadBudget_)
+				continue; // next time
+			++loads;
+			Entry entry;
+			try {
+				if (load(table.name(*itr), entry, now))
+					entries[*itr] = entry;
+			} catch (const DBus::Error &) {
+				timeout = std::current_exception();
+			}
+		}
+		for (std::vector<PathId>::const_iterator itr = stale.begin(); itr != stale.end(); ++itr) {
+			bool reuse = timeout || loads >= loadBudget_;
+			Metrics::instance().cache(Metrics::DEVICE_CACHE, reuse);
+			if (reuse)
+				continue;
+			++loads;
+			try {
+				load(table.name(*itr), entries[*itr], now);
+			} catch (const DBus::Error &) {
+				timeout = std::current_exception();
+			}
+		}
+		entries_.swap(entries);
+
+		DeviceTable::map_type devices;
+		for (std::map<PathId, Entry>::const_iterator itr = entries_.begin(); itr != entries_.end(); ++itr)
+			devices[itr->second.info->interface] = itr->second.info;
+		state_.update(devices, now);
+		table.sweep(); // paths just interned survive it: they were in this reply
+		if (timeout)
+			std::rethrow_exception(timeout);
+	}
+
+private:
+	struct Entry {
+		DeviceTable::device_pointer info;
+		time_t loaded;
+	};
+
+	bool load(const std::string & path, Entry & entry, time_t now) {
+		try {
+			org::freedesktop::NetworkManager::Device_mirror device;
+			device.decode_GetAll(getAll(path, device.interface_name()));
+
+			std::shared_ptr<DeviceInfo> info(new DeviceInfo());
+			info->interface = device.IpInterface.empty() ? device.Interface : device.IpInterface;
+			info->path = path;
+			info->driver = device.Driver;
+			info->deviceType = device.DeviceType;
+			info->state = device.State;
+			info->mtu = device.Mtu;
+			info->managed = device.Managed;
+			std::string ip4config = device.Ip4Config;
+			if (!ip4config.empty() && ip4config != "/") {
+				org::freedesktop::NetworkManager::IP4Config_mirror config;
+				config.decode_GetAll(getAll(ip4config, config.interface_name()));
+				info->hasIp4Config = true;
+				info->ip4config = convert(config);
+			}
+
+			// Keep the old pointer when nothing changed, so DeviceState
+			// sees an unchanged table.
+			if (!entry.info || !same(*entry.info, *info))
+				entry.info = info;
+			entry.loaded = now;
+			return true;
+		} catch (const DBus::Error & e) {
+			if (timedOut(e))
+				throw;
+			return false;
+		}
+	}
+
+	DBus::Message getAll(const std::string & path, const char * interface) {
+		DBus::CallMessage call(service_, path.c_str(), "org.freedesktop.DBus.Properties", "GetAll");
+		DBus::MessageIter wi = call.writer();
+		wi << std::string(interface);
+		Metrics::DBusTimer timer(Metrics::DEVICE_GET_ALL);
+		return connection_.send_blocking(call, timeoutMs_);
+	}
+
+	static Ip4Config convert(org::freedesktop::NetworkManager::IP4Config_mirror & config) {
+		Ip4Config ip4;
+		for (size_t i = 0; i < config.AddressData.size(); ++i) {
+			std::map< std::string, ::DBus::Variant > & data = config.AddressData[i];
+			if (data.count("address") == 0)
+				continue;
+			std::string text = data["address"];
+			IpAddress address;
+			if (!IpAddress::parse(text, address))
+				continue;
+			if (data.count("prefix")) {
+				uint32_t prefix = data["prefix"];
+				if (prefix <= address.maxPrefix())
+					address.prefix = static_cast<uint8_t>(prefix);
+			}
+			ip4.addresses.push_back(address);
+		}
+		IpAddress::parse(config.Gateway, ip4.gateway);
+		for (size_t i = 0; i < config.Nameservers.size(); ++i)
+			ip4.nameservers.push_back(IpAddress::v4(ntohl(config.Nameservers[i])));
+		return ip4;
+	}
+
+	static bool same(const DeviceInfo & a, const DeviceInfo & b) {
+		std::string x, y;
+		a.encodeJson(x);
+		b.encodeJson(y);
+		if (a.hasIp4Config)
+			a.ip4config.encodeJson(x);
+		if (b.hasIp4Config)
+			b.ip4config.encodeJson(y);
+		return x == y;
+	}
+
+	static bool timedOut(const DBus::Error & e) {
+		const char * name = e.name();
+		return name && (!strcmp(name, "org.freedesktop.DBus.Error.NoReply") || !strcmp(name, "org.freedesktop.DBus.Error.Timeout"));
+	}
+
+	DBus::Connection & connection_;
+	DeviceState & state_;
+	const int timeoutMs_;
+	const char * service_;
+	const size_t loadBudget_;
+	const time_t reloadAge_;
+	std::map<PathId, Entry> entries_; // by interned object path; refresher thread only
+};
+#endif // DEVICE_CACHE_H
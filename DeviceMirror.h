@@ -0,0 +1,269 @@
+/*
+ *	This file was automatically generated by xml2mirror; DO NOT EDIT!
+ */
+
+#ifndef __xml2mirror__DeviceMirror_h
+#define __xml2mirror__DeviceMirror_h
+
+#include <dbus-c++/dbus.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace org {
+namespace freedesktop {
+namespace NetworkManager {
+
+struct Device_mirror
+{
+    static const char *interface_name() { return "org.freedesktop.NetworkManager.Device"; }
+
+    /* properties exported by this interface */
+    std::string Udi;
+    std::string Interface;
+    std::string IpInterface;
+    std::string Driver;
+    std::string DriverVersion;
+    std::string FirmwareVersion;
+    uint32_t Capabilities;
+    uint32_t State;
+    ::DBus::Path ActiveConnection;
+    ::DBus::Path Ip4Config;
+    ::DBus::Path Dhcp4Config;
+    ::DBus::Path Ip6Config;
+    ::DBus::Path Dhcp6Config;
+    bool Managed;
+    bool Autoconnect;
+    bool FirmwareMissing;
+    uint32_t DeviceType;
+    std::vector< ::DBus::Path > AvailableConnections;
+    std::string PhysicalPortId;
+    uint32_t Mtu;
+
+    Device_mirror()
+    : Udi()
+    , Interface()
+    , IpInterface()
+    , Driver()
+    , DriverVersion()
+    , FirmwareVersion()
+    , Capabilities()
+    , State()
+    , ActiveConnection()
+    , Ip4Config()
+    , Dhcp4Config()
+    , Ip6Config()
+    , Dhcp6Config()
+    , Managed()
+    , Autoconnect()
+    , FirmwareMissing()
+    , DeviceType()
+    , AvailableConnections()
+    , PhysicalPortId()
+    , Mtu()
+    {
+    }
+
+    /* Decodes one property value from vi into its member; false for names
+     * this interface does not have. */
+    bool apply(const std::string &name, ::DBus::MessageIter &vi)
+    {
+        if (name == "Udi")
+            vi >> Udi;
+        else if (name == "Interface")
+            vi >> Interface;
+        else if (name == "IpInterface")
+            vi >> IpInterface;
+        else if (name == "Driver")
+            vi >> Driver;
+        else if (name == "DriverVersion")
+            vi >> DriverVersion;
+        else if (name == "FirmwareVersion")
+            vi >> FirmwareVersion;
+        else if (name == "Capabilities")
+            vi >> Capabilities;
+        else if (name == "State")
+            vi >> State;
+        else if (name == "ActiveConnection")
+            vi >> ActiveConnection;
+        else if (name == "Ip4Config")
+            vi >> Ip4Config;
+        else if (name == "Dhcp4Config")
+            vi >> Dhcp4Config;
+        else if (name == "Ip6Config")
+            vi >> Ip6Config;
+        else if (name == "Dhcp6Config")
+            vi >> Dhcp6Config;
+        else if (name == "Managed")
+            vi >> Managed;
+        else if (name == "Autoconnect")
+            vi >> Autoconnect;
+        else if (name == "FirmwareMissing")
+            vi >> FirmwareMissing;
+        else if (name == "DeviceType")
+            vi >> DeviceType;
+        else if (name == "AvailableConnections")
+            vi >> AvailableConnections;
+        else if (name == "PhysicalPortId")
+            vi >> PhysicalPortId;
+        else if (name == "Mtu")
+            vi >> Mtu;
+        else
+            return false;
+        return true;
+    }
+
+    bool apply(const std::string &name, const ::DBus::Variant &value)
+    {
+        ::DBus::MessageIter vi = value.reader();
+        return apply(name, vi);
+    }
+
+    /* PropertiesChanged delta; returns the number of members updated. */
+    size_t apply(const std::map< std::string, ::DBus::Variant > &props)
+    {
+        size_t applied = 0;
+        for (std::map< std::string, ::DBus::Variant >::const_iterator it = props.begin(); it != props.end(); ++it)
+            applied += apply(it->first, it->second);
+        return applied;
+    }
+
+    /* org.freedesktop.DBus.Properties.GetAll reply (a{sv}), decoded straight
+     * from the message into the members. */
+    size_t decode_GetAll(const ::DBus::Message &reply)
+    {
+        ::DBus::MessageIter ri = reply.reader();
+        ::DBus::MessageIter dict = ri.recurse();
+        size_t applied = 0;
+        for (; !dict.at_end(); ++dict) {
+            ::DBus::MessageIter entry = dict.recurse();
+            std::string name;
+            entry >> name;
+            ::DBus::MessageIter vi = entry.recurse();
+            applied += apply(name, vi);
+        }
+        return applied;
+    }
+
+    /* One GetAll round trip through proxy, an object proxy for this interface. */
+    size_t GetAll(::DBus::InterfaceProxy &proxy)
+    {
+        ::DBus::CallMessage call;
+        call.member("GetAll"); call.interface("org.freedesktop.DBus.Properties");
+        ::DBus::MessageIter wi = call.writer();
+        const std::string interface = interface_name();
+        wi << interface;
+        ::DBus::Message ret = proxy.invoke_method(call);
+        return decode_GetAll(ret);
+    }
+};
+
+} // namespace NetworkManager
+} // namespace freedesktop
+} // namespace org
+
+namespace org {
+namespace freedesktop {
+namespace NetworkManager {
+
+struct IP4Config_mirror
+{
+    static const char *interface_name() { return "org.freedesktop.NetworkManager.IP4Config"; }
+
+    /* properties exported by this interface */
+    std::vector< std::vector< uint32_t > > Addresses;
+    std::vector< std::map< std::string, ::DBus::Variant > > AddressData;
+    std::string Gateway;
+    std::vector< std::vector< uint32_t > > Routes;
+    std::vector< uint32_t > Nameservers;
+    std::vector< std::string > Domains;
+    std::vector< std::string > Searches;
+    std::vector< uint32_t > WinsServers;
+
+    IP4Config_mirror()
+    : Addresses()
+    , AddressData()
+    , Gateway()
+    , Routes()
+    , Nameservers()
+    , Domains()
+    , Searches()
+    , WinsServers()
+    {
+    }
+
+    /* Decodes one property value from vi into its member; false for names
+     * this interface does not have. */
+    bool apply(const std::string &name, ::DBus::MessageIter &vi)
+    {
+        if (name == "Addresses")
+            vi >> Addresses;
+        else if (name == "AddressData")
+            vi >> AddressData;
+        else if (name == "Gateway")
+            vi >> Gateway;
+        else if (name == "Routes")
+            vi >> Routes;
+        else if (name == "Nameservers")
+            vi >> Nameservers;
+        else if (name == "Domains")
+            vi >> Domains;
+        else if (name == "Searches")
+            vi >> Searches;
+        else if (name == "WinsServers")
+            vi >> WinsServers;
+        else
+            return false;
+        return true;
+    }
+
+    bool apply(const std::string &name, const ::DBus::Variant &value)
+    {
+        ::DBus::MessageIter vi = value.reader();
+        return apply(name, vi);
+    }
+
+    /* PropertiesChanged delta; returns the number of members updated. */
+    size_t apply(const std::map< std::string, ::DBus::Variant > &props)
+    {
+        size_t applied = 0;
+        for (std::map< std::string, ::DBus::Variant >::const_iterator it = props.begin(); it != props.end(); ++it)
+            applied += apply(it->first, it->second);
+        return applied;
+    }
+
+    /* org.freedesktop.DBus.Properties.GetAll reply (a{sv}), decoded straight
+     * from the message into the members. */
+    size_t decode_GetAll(const ::DBus::Message &reply)
+    {
+        ::DBus::MessageIter ri = reply.reader();
+        ::DBus::MessageIter dict = ri.recurse();
+        size_t applied = 0;
+        for (; !dict.at_end(); ++dict) {
+            ::DBus::MessageIter entry = dict.recurse();
+            std::string name;
+            entry >> name;
+            ::DBus::MessageIter vi = entry.recurse();
+            applied += apply(name, vi);
+        }
+        return applied;
+    }
+
+    /* One GetAll round trip through proxy, an object proxy for this interface. */
+    size_t GetAll(::DBus::InterfaceProxy &proxy)
+    {
+        ::DBus::CallMessage call;
+        call.member("GetAll"); call.interface("org.freedesktop.DBus.Properties");
+        ::DBus::MessageIter wi = call.writer();
+        const std::string interface = interface_name();
+        wi << interface;
+        ::DBus::Message ret = proxy.invoke_method(call);
+        return decode_GetAll(ret);
+    }
+};
+
+} // namespace NetworkManager
+} // namespace freedesktop
+} // namespace org
+
+#endif //__xml2mirror__DeviceMirror_h
@@ -0,0 +1,190 @@
+#ifndef DEVICE_TABLE_H
+#define DEVICE_TABLE_H
+
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <cereal/types/vector.hpp>
+
+#include "ETag.h"
+#include "FieldProjection.h"
+#include "IpAddress.h"
+#include "JsonEncoder.h"
+#include "Rcu.h"
+
+// IPv4 configuration of a device, from its IP4Config object.
+struct Ip4Config {
+	std::vector<IpAddress> addresses; // with their prefix
+	IpAddress gateway;
+	std::vector<IpAddress> nameservers;
+
+	// {"addresses":["10.0.0.5/24"],"gateway":"10.0.0.1","nameservers":[...]}
+	void encodeJson(std::string & out) const
+	{
+		out.append("{\"addresses\":[", 14);
+		for (size_t i = 0; i < addresses.size(); ++i) {
+			if (i)
+				out += ',';
+			appendJsonString(out, addresses[i].str(true));
+		}
+		out.append("],\"gateway\":", 12);
+		gateway.encodeJson(out);
+		out.append(",\"nameservers\":", 15);
+		encodeJsonValue(out, nameservers);
+		out += '}';
+	}
+
+	// cereal, for copies between processes.
+	template<class Archive>
+	void serialize(Archive & archive)
+	{
+		archive(addresses, gateway, nameservers);
+	}
+};
+
+#define DEVICE_INFO_FIELDS(FIELD) FIELD(interface) FIELD(path) FIELD(driver) FIELD(deviceType) FIELD(state) FIELD(mtu) FIELD(managed)
+
+// One NetworkManager device as served under /devices, flattened from its
+// Device properties.
+struct DeviceInfo {
+	std::string interface;  // IpInterface, or Interface when there is none
+	std::string path;       // D-Bus object path
+	std::string driver;
+	uint32_t deviceType;
+	uint32_t state;
+	uint32_t mtu;
+	bool managed;
+	bool hasIp4Config;
+	Ip4Config ip4config;
+
+	DeviceInfo(): deviceType(0), state(0), mtu(0), managed(false), hasIp4Config(false) {}
+
+	void encodeJson(std::string & out, const FieldSet * fields = 0) const
+	{
+		jsonObject(out, fields DEVICE_INFO_FIELDS(JSON_FIELD));
+	}
+
+	template<class Archive>
+	void serialize(Archive & archive)
+	{
+		archive(hasIp4Config, ip4config DEVICE_INFO_FIELDS(CEREAL_NVP_ARG));
+	}
+};
+
+// Immutable, interface-ordered set of devices. Pages are addressed by the
+// last interface name seen, so a cursor stays valid while devices come
+// and go around it, and finding a page costs one map lookup.
+class DeviceTable {
+public:
+	typedef std::shared_ptr<const DeviceInfo> device_pointer;
+	typedef std::map<std::string, device_pointer> map_type;
+
+	DeviceTable(): generation_(0), modified_(0), epoch_(0) {}
+	DeviceTable(const map_type & devices, uint64_t generation, time_t modified, uint64_t epoch = 0):
+	devices_(devices), generation_(generation), modified_(modified), epoch_(epoch) {}
+
+	const DeviceInfo * find(const std::string & interface) const {
+		map_type::const_iterator itr = devices_.find(interface);
+		return itr == devices_.end() ? 0 : itr->second.get();
+	}
+
+	// Up to limit devices after the interface named by cursor (from the
+	// start if empty). next is the cursor for the following page, empty on
+	// the last one.
+	std::vector<const DeviceInfo *> page(const std::string & cursor, size_t limit, std::string & next) const {
+		std::vector<const DeviceInfo *> devices;
+		map_type::const_iterator itr = cursor.empty() ? devices_.begin() : devices_.upper_bound(cursor);
+		for (; itr != devices_.end() && devices.size() < limit; ++itr)
+			devices.push_back(itr->second.get());
+		next = itr != devices_.end() && !devices.empty() ? devices.back()->interface : std::string();
+		return devices;
+	}
+
+	const map_type & devices() const { return devices_; }
+	size_t size() const { return devices_.size(); }
+	uint64_t generation() const { return generation_; }
+	time_t modified() const { return modified_; }
+	uint64_t epoch() const { return epoch_; }
+
+	// Entity tag of what key (the resource and its query) selects from this
+	// generation, so a response's tag is known without encoding it.
+	std::string etag(const std::string & key) const {
+		uint64_t hash = fnv1a64(reinterpret_cast<const char *>(&epoch_), sizeof(epoch_));
+		hash = fnv1a64(reinterpret_cast<const char *>(&generation_), sizeof(generation_), hash);
+		return strongETag(fnv1a64(key.data(), key.size(), hash));
+	}
+
+private:
+	map_type devices_;
+	uint64_t generation_;
+	time_t modified_;
+	uint64_t epoch_; // of the DeviceState that numbered the generation
+};
+
+// The current DeviceTable, published like NetworkState: workers read it
+// through a Reader without locking, update() is called from the D-Bus side.
+class DeviceState {
+public:
+	class Reader {
+	public:
+		Reader() {}
+		explicit Reader(const DeviceState & state) { open(state); }
+
+		void open(const DeviceState & state) { table_.open(state.table_); }
+
+		// Null until the first update.
+		const DeviceTable * table() const { return table_.get(); }
+
+	private:
+		RcuCell<DeviceTable>::Reader table_;
+	};
+
+	explicit DeviceState(uint64_t epoch = newEpoch()): epoch_(epoch), generation_(0) {}
+
+	// Replaces the device set; the generation only moves if a device was
+	// added, removed or changed. Returns true if it did.
+	bool update(const DeviceTable::map_type & devices, time_t now = time(0)) {
+		std::lock_guard<std::mutex> lock(writeMutex_);
+		const DeviceTable * current = table_.current();
+		if (current && sameDevices(current->devices(), devices))
+			return false;
+		table_.publish(new DeviceTable(devices, ++generation_, now, epoch_));
+		return true;
+	}
+
+	// Publishes devices as the given generation of another process's
+	// state (see SharedSnapshot), so that entity tags agree across
+	// processes. Returns false if that is the current one already.
+	bool adopt(const DeviceTable::map_type & devices, uint64_t epoch, uint64_t generation, time_t modified) {
+		std::lock_guard<std::mutex> lock(writeMutex_);
+		if (table_.current() && epoch == epoch_ && generation == generation_)
+			return false;
+		epoch_ = epoch;
+		generation_ = generation;
+		table_.publish(new DeviceTable(devices, generation, modified, epoch));
+		return true;
+	}
+
+private:
+	// Entries are immutable and shared, so unchanged devices compare by
+	// pointer.
+	static bool sameDevices(const DeviceTable::map_type & a, const DeviceTable::map_type & b) {
+		if (a.size() != b.size())
+			return false;
+		for (DeviceTable::map_type::const_iterator i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j)
+			if (i->first != j->first || i->second != j->second)
+				return false;
+		return true;
+	}
+
+	std::mutex writeMutex_;
+	uint64_t epoch_;
+	uint64_t generation_;
+	RcuCell<DeviceTable> table_;
+};
+#endif // DEVICE_TABLE_H
@@ -0,0 +1,59 @@
+#ifndef ETAG_H
+#define ETAG_H
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <stdint.h>
+
+#include <unistd.h>
+
+// 64-bit FNV-1a. Not cryptographic, but fast and stable across processes,
+// so every FastCGI instance derives the same tag for the same content.
+inline uint64_t fnv1a64(const char * data, size_t length, uint64_t hash = 14695981039346656037ULL)
+{
+	for (size_t i = 0; i < length; ++i) {
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+inline uint64_t fnv1a64(const std::string & data)
+{
+	return fnv1a64(data.data(), data.size());
+}
+
+// Strong entity tag (quoted, as sent in ETag and received in If-None-Match).
+inline std::string strongETag(uint64_t hash)
+{
+	static const char digits[] = "0123456789abcdef";
+	char buf[18];
+	buf[0] = '"';
+	for (int i = 16; i > 0; --i) {
+		buf[i] = digits[hash & 0xf];
+		hash >>= 4;
+	}
+	buf[17] = '"';
+	return std::string(buf, sizeof(buf));
+}
+
+inline std::string strongETag(const std::string & body)
+{
+	return strongETag(fnv1a64(body));
+}
+
+// Unique to this process and its start: a hash of the boot id, the pid and
+// the time. Never 0. Qualifies generation numbers, which restart at 1 in
+// every process, wherever they end up in a tag or an id.
+inline uint64_t newEpoch()
+{
+	std::string seed;
+	std::ifstream bootId("/proc/sys/kernel/random/boot_id");
+	std::getline(bootId, seed);
+	seed += ';' + std::to_string(getpid());
+	seed += ';' + std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+	uint64_t epoch = fnv1a64(seed);
+	return epoch ? epoch : 1;
+}
+#endif // ETAG_H
@@ -0,0 +1,94 @@
+#ifndef EVENT_RING_H
+#define EVENT_RING_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+struct NetworkEvent {
+	uint64_t id;
+	string type;
+	string data;
+};
+
+// Bounded, in-memory history of NetworkManager signals. Ids start at 1 and
+// increase by one per event, so a client's Last-Event-ID tells exactly which
+// events it is missing; once the ring has dropped some of them the client
+// has to start again from a full snapshot.
+class EventRing {
+public:
+	EventRing(size_t capacity = 256): capacity_(capacity ? capacity : 1), lastId_(0), closed_(false) {}
+
+	uint64_t publish(const string & type, const string & data) {
+		uint64_t id;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			NetworkEvent event;
+			event.id = id = ++lastId_;
+			event.type = type;
+			event.data = data;
+			if (events_.size() == capacity_)
+				events_.pop_front();
+			events_.push_back(event);
+		}
+		changed_.notify_all();
+		return id;
+	}
+
+	// Append the events after lastId to out. Returns false if some of them
+	// were already dropped (out then holds everything still available).
+	bool since(uint64_t lastId, vector<NetworkEvent> & out) const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		bool complete = events_.empty() ? lastId == lastId_ : events_.front().id <= lastId + 1;
+		if (lastId > lastId_) { // From a previous process, treat as lost.
+			lastId = 0;
+			complete = false;
+		}
+		std::deque<NetworkEvent>::const_iterator it = events_.begin();
+		if (!events_.empty() && lastId >= events_.front().id)
+			it += lastId - events_.front().id + 1;
+		out.insert(out.end(), it, events_.end());
+		return complete;
+	}
+
+	// Block until an event newer than lastId exists, the ring is closed or
+	// the timeout expires. Returns true if there is something to read.
+	bool wait(uint64_t lastId, std::chrono::milliseconds timeout) const {
+		std::unique_lock<std::mutex> lock(mutex_);
+		return changed_.wait_for(lock, timeout, [&] { return closed_ || lastId_ != lastId; }) && !closed_;
+	}
+
+	uint64_t lastId() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return lastId_;
+	}
+
+	bool closed() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return closed_;
+	}
+
+	// Wake all waiters for shutdown.
+	void close() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			closed_ = true;
+		}
+		changed_.notify_all();
+	}
+
+private:
+	mutable std::mutex mutex_;
+	mutable std::condition_variable changed_;
+	std::deque<NetworkEvent> events_;
+	size_t capacity_;
+	uint64_t lastId_;
+	bool closed_;
+};
+#endif // EVENT_RING_H
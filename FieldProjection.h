@@ -0,0 +1,124 @@
+#ifndef FIELD_PROJECTION_H
+#define FIELD_PROJECTION_H
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+
+// Member names requested with ?fields=a,b,c.
+class FieldSet {
+	std::vector<std::string> names_; // sorted, unique
+
+	struct less {
+		bool operator()(const std::string & a, const char * b) const { return a.compare(b) < 0; }
+		bool operator()(const char * a, const std::string & b) const { return b.compare(a) > 0; }
+	};
+
+	struct name_ref {
+		const char * name;
+		size_t length;
+	};
+
+	struct less_ref {
+		bool operator()(const std::string & a, const name_ref & b) const { return a.compare(0, a.size(), b.name, b.length) < 0; }
+		bool operator()(const name_ref & a, const std::string & b) const { return b.compare(0, b.size(), a.name, a.length) > 0; }
+	};
+
+public:
+	FieldSet() {}
+
+	static FieldSet parse(const std::string & csv) {
+		FieldSet fields;
+		std::string::size_type begin = 0;
+		while (begin <= csv.size()) {
+			std::string::size_type end = csv.find(',', begin);
+			if (end == std::string::npos)
+				end = csv.size();
+			std::string::size_type first = csv.find_first_not_of(' ', begin);
+			std::string::size_type last = csv.find_last_not_of(' ', end - 1);
+			if (first < end && last != std::string::npos && last >= first)
+				fields.names_.push_back(csv.substr(first, last - first + 1));
+			begin = end + 1;
+		}
+		std::sort(fields.names_.begin(), fields.names_.end());
+		fields.names_.erase(std::unique(fields.names_.begin(), fields.names_.end()), fields.names_.end());
+		return fields;
+	}
+
+	bool empty() const { return names_.empty(); }
+
+	bool contains(const char * name) const {
+		return std::binary_search(names_.begin(), names_.end(), name, less());
+	}
+
+	// name need not be terminated.
+	bool contains(const char * name, size_t length) const {
+		name_ref ref = { name, length };
+		return std::binary_search(names_.begin(), names_.end(), ref, less_ref());
+	}
+
+	// Canonical form, equal for equal sets ("a,b" and "b, a").
+	std::string key() const {
+		std::string key;
+		for (size_t i = 0; i < names_.size(); ++i) {
+			if (i)
+				key += ',';
+			key += names_[i];
+		}
+		return key;
+	}
+};
+
+// Any cereal archive, carrying the fields to emit. Serialize functions that
+// list their members with project() then skip the others before they ever
+// reach the archive, so they are never formatted.
+template<class Archive>
+class ProjectingArchive : public Archive {
+	const FieldSet & fields_;
+
+public:
+	template<class ... Args>
+	ProjectingArchive(const FieldSet & fields, Args && ... args):
+	Archive(std::forward<Args>(args)...), fields_(fields) {}
+
+	const FieldSet & fields() const { return fields_; }
+};
+
+// Fields requested for archive, or null if it wants every member. cereal
+// hands serialize() the wrapped archive type, hence the cast.
+template<class Archive>
+const FieldSet * projection(Archive & archive)
+{
+	ProjectingArchive<Archive> * projecting = dynamic_cast<ProjectingArchive<Archive> *>(&archive);
+	return projecting ? &projecting->fields() : 0;
+}
+
+template<class Archive>
+void projectEach(Archive &, const FieldSet &) {}
+
+template<class Archive, class T, class ... Rest>
+void projectEach(Archive & archive, const FieldSet & fields, cereal::NameValuePair<T> && nvp, Rest && ... rest)
+{
+	if (fields.contains(nvp.name))
+		archive(std::move(nvp));
+	projectEach(archive, fields, std::forward<Rest>(rest)...);
+}
+
+// Drop-in for archive(CEREAL_NVP(a), CEREAL_NVP(b), ...) in serialize().
+template<class Archive, class ... Types>
+void project(Archive & archive, Types && ... nvps)
+{
+	const FieldSet * fields = projection(archive);
+	if (fields)
+		projectEach(archive, *fields, std::forward<Types>(nvps)...);
+	else
+		archive(std::forward<Types>(nvps)...);
+}
+
+// X-macro argument for member lists: project(archive FOO_FIELDS(CEREAL_NVP_ARG)).
+#define CEREAL_NVP_ARG(m) , CEREAL_NVP(m)
+#endif // FIELD_PROJECTION_H
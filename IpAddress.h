@@ -0,0 +1,236 @@
+#ifndef IP_ADDRESS_H
+#define IP_ADDRESS_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include <arpa/inet.h>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/string.hpp>
+
+// An IPv4 or IPv6 address with a prefix length, in 18 bytes and no heap.
+// A plain aggregate, so records holding it can live in contiguous arrays
+// and be copied with memcpy. The zero value is "no address" and formats
+// as the empty string.
+struct IpAddress {
+	enum { NONE = 0, V4 = 4, V6 = 6 };
+	// Longest text form: an IPv6 address with an embedded IPv4 tail and a
+	// "/128" suffix, plus the terminator.
+	enum { MAX_TEXT = INET6_ADDRSTRLEN + 4 };
+
+	uint8_t family;
+	uint8_t prefix;     // 0..32 or 0..128
+	uint8_t bytes[16];  // network order; IPv4 uses the first 4
+
+	static IpAddress v4(uint32_t word, uint8_t prefix = 32) {
+		IpAddress a = IpAddress();
+		a.family = V4;
+		a.prefix = prefix;
+		a.bytes[0] = static_cast<uint8_t>(word >> 24);
+		a.bytes[1] = static_cast<uint8_t>(word >> 16);
+		a.bytes[2] = static_cast<uint8_t>(word >> 8);
+		a.bytes[3] = static_cast<uint8_t>(word);
+		return a;
+	}
+
+	static IpAddress v6(const uint8_t (&bytes)[16], uint8_t prefix = 128) {
+		IpAddress a = IpAddress();
+		a.family = V6;
+		a.prefix = prefix;
+		memcpy(a.bytes, bytes, 16);
+		return a;
+	}
+
+	// The IPv4 address as a host-order word.
+	uint32_t word() const {
+		return uint32_t(bytes[0]) << 24 | uint32_t(bytes[1]) << 16 | uint32_t(bytes[2]) << 8 | bytes[3];
+	}
+
+	bool empty() const { return family == NONE; }
+	unsigned maxPrefix() const { return family == V6 ? 128 : family == V4 ? 32 : 0; }
+
+	// The netmask of prefix in this family, e.g. 255.255.255.0 for a /24.
+	IpAddress mask() const {
+		IpAddress m = IpAddress();
+		m.family = family;
+		m.prefix = maxPrefix();
+		for (unsigned i = 0; i < m.prefix / 8u; ++i)
+			m.bytes[i] = i < prefix / 8u ? 0xff : i == prefix / 8u ? static_cast<uint8_t>(0xff00 >> (prefix % 8)) : 0;
+		return m;
+	}
+
+	// Leading one bits if this is a contiguous netmask, otherwise -1.
+	int maskLength() const {
+		unsigned bits = 0, n = maxPrefix() / 8;
+		unsigned i = 0;
+		for (; i < n && bytes[i] == 0xff; ++i)
+			bits += 8;
+		if (i < n) {
+			uint8_t b = bytes[i++];
+			while (b & 0x80) {
+				++bits;
+				b = static_cast<uint8_t>(b << 1);
+			}
+			if (b)
+				return -1;
+		}
+		for (; i < n; ++i)
+			if (bytes[i])
+				return -1;
+		return static_cast<int>(bits);
+	}
+
+	// Parse "a.b.c.d" or an IPv6 address, optionally followed by "/prefix".
+	// An empty string gives the empty address. Returns false on anything
+	// else, leaving out untouched.
+	static bool parse(const char * s, size_t length, IpAddress & out) {
+		if (length == 0) {
+			out = IpAddress();
+			return true;
+		}
+		const char * slash = static_cast<const char *>(memchr(s, '/', length));
+		size_t addrLength = slash ? size_t(slash - s) : length;
+		IpAddress a = IpAddress();
+		if (!parseV4(s, addrLength, a)) {
+			char text[INET6_ADDRSTRLEN];
+			if (addrLength >= sizeof(text))
+				return false;
+			memcpy(text, s, addrLength);
+			text[addrLength] = 0;
+			if (inet_pton(AF_INET6, text, a.bytes) != 1)
+				return false;
+			a.family = V6;
+		}
+		a.prefix = static_cast<uint8_t>(a.maxPrefix());
+		if (slash) {
+			unsigned prefix = 0;
+			const char * p = slash + 1, * end = s + length;
+			if (p == end || end - p > 3)
+				return false;
+			for (; p != end; ++p) {
+				if (*p < '0' || *p > '9')
+					return false;
+				prefix = prefix * 10 + (*p - '0');
+			}
+			if (prefix > a.maxPrefix())
+				return false;
+			a.prefix = static_cast<uint8_t>(prefix);
+		}
+		out = a;
+		return true;
+	}
+
+	static bool parse(const std::string & s, IpAddress & out) {
+		return parse(s.data(), s.size(), out);
+	}
+
+	// Writes the address, and "/prefix" if withPrefix, to out (at least
+	// MAX_TEXT bytes) without a terminator. Returns the length.
+	size_t format(char * out, bool withPrefix = false) const {
+		char * p = out;
+		if (family == V4) {
+			for (int i = 0; i < 4; ++i) {
+				if (i)
+					*p++ = '.';
+				p = formatDecimal(p, bytes[i]);
+			}
+		} else if (family == V6) {
+			char text[INET6_ADDRSTRLEN];
+			inet_ntop(AF_INET6, bytes, text, sizeof(text));
+			size_t n = strlen(text);
+			memcpy(p, text, n);
+			p += n;
+		} else {
+			return 0;
+		}
+		if (withPrefix) {
+			*p++ = '/';
+			p = formatDecimal(p, prefix);
+		}
+		return p - out;
+	}
+
+	std::string str(bool withPrefix = false) const {
+		char text[MAX_TEXT];
+		return std::string(text, format(text, withPrefix));
+	}
+
+	// Quoted JSON string, for JsonEncoder.
+	void encodeJson(std::string & out) const {
+		char text[MAX_TEXT + 2];
+		text[0] = '"';
+		size_t n = format(text + 1);
+		text[n + 1] = '"';
+		out.append(text, n + 2);
+	}
+
+	bool operator==(const IpAddress & o) const {
+		return family == o.family && prefix == o.prefix && memcmp(bytes, o.bytes, sizeof(bytes)) == 0;
+	}
+	bool operator!=(const IpAddress & o) const { return !(*this == o); }
+
+private:
+	static bool parseV4(const char * s, size_t length, IpAddress & a) {
+		const char * p = s, * end = s + length;
+		for (int i = 0; i < 4; ++i) {
+			if (i && (p == end || *p++ != '.'))
+				return false;
+			unsigned octet = 0, digits = 0;
+			for (; p != end && *p >= '0' && *p <= '9'; ++p, ++digits)
+				octet = octet * 10 + (*p - '0');
+			if (digits == 0 || digits > 3 || octet > 255)
+				return false;
+			a.bytes[i] = static_cast<uint8_t>(octet);
+		}
+		if (p != end)
+			return false;
+		a.family = V4;
+		return true;
+	}
+
+	static char * formatDecimal(char * p, unsigned n) {
+		if (n >= 100)
+			*p++ = static_cast<char>('0' + n / 100);
+		if (n >= 10)
+			*p++ = static_cast<char>('0' + n / 10 % 10);
+		*p++ = static_cast<char>('0' + n % 10);
+		return p;
+	}
+};
+
+static_assert(std::is_pod<IpAddress>::value && sizeof(IpAddress) == 18, "IpAddress must stay a compact POD");
+
+// Text archives (JSON) carry the usual notation, so documents read the
+// same as before; binary archives carry family, prefix and raw bytes.
+template<class Archive>
+typename std::enable_if<cereal::traits::is_text_archive<Archive>::value, std::string>::type
+save_minimal(const Archive &, const IpAddress & address)
+{
+	return address.str();
+}
+
+template<class Archive>
+typename std::enable_if<cereal::traits::is_text_archive<Archive>::value>::type
+load_minimal(const Archive &, IpAddress & address, const std::string & text)
+{
+	if (!IpAddress::parse(text, address))
+		throw cereal::Exception("invalid IP address: " + text);
+}
+
+template<class Archive>
+typename std::enable_if<!cereal::traits::is_text_archive<Archive>::value>::type
+save(Archive & archive, const IpAddress & address)
+{
+	archive(address.family, address.prefix, cereal::binary_data(&address.bytes[0], sizeof(address.bytes)));
+}
+
+template<class Archive>
+typename std::enable_if<!cereal::traits::is_text_archive<Archive>::value>::type
+load(Archive & archive, IpAddress & address)
+{
+	archive(address.family, address.prefix, cereal::binary_data(&address.bytes[0], sizeof(address.bytes)));
+}
+#endif // IP_ADDRESS_H
@@ -0,0 +1,172 @@
+#ifndef JOB_TABLE_H
+#define JOB_TABLE_H
+
+#include <ctime>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <stdint.h>
+
+#include "JsonEncoder.h"
+
+#define JOB_FIELDS(FIELD) FIELD(id) FIELD(operation) FIELD(state) FIELD(done) FIELD(activeConnection) FIELD(error) FIELD(updated)
+
+// A connection activation or deactivation that was accepted with 202 and
+// runs on without the request. state goes
+//
+//   queued -> running -> activating -> activated | failed      (activate)
+//   queued -> running -> deactivating -> deactivated | failed  (deactivate)
+//
+// where everything after running follows the ActiveConnection's state
+// signals.
+struct Job {
+	uint64_t id;
+	std::string operation;        // "activate", "add-and-activate" or "deactivate"
+	std::string state;
+	bool done;
+	std::string activeConnection; // D-Bus object path, once known
+	std::string error;
+	int64_t updated;              // time_t of the last change
+
+	Job(): id(0), done(false), updated(0) {}
+
+	bool deactivating() const { return operation == "deactivate"; }
+
+	void encodeJson(std::string & out) const
+	{
+		jsonObject(out, 0 JOB_FIELDS(JSON_FIELD));
+	}
+};
+
+// Recent jobs by id, oldest dropped first past MAX_JOBS. Written from the
+// job thread and the D-Bus dispatcher, read by request workers; jobs are
+// rare, so a mutex is all it needs.
+class JobTable {
+public:
+	enum { MAX_JOBS = 256 };
+
+	// NM_ACTIVE_CONNECTION_STATE_*
+	enum { UNKNOWN = 0, ACTIVATING = 1, ACTIVATED = 2, DEACTIVATING = 3, DEACTIVATED = 4 };
+
+	JobTable(): nextId_(1) {}
+
+	uint64_t create(const std::string & operation, const std::string & activeConnection = std::string(), time_t now = time(0)) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		Job & job = jobs_[nextId_];
+		job.id = nextId_;
+		job.operation = operation;
+		job.state = "queued";
+		job.activeConnection = activeConnection;
+		job.updated = now;
+		order_.push_back(nextId_);
+		if (order_.size() > MAX_JOBS) {
+			jobs_.erase(order_.front());
+			order_.pop_front();
+		}
+		return nextId_++;
+	}
+
+	bool find(uint64_t id, Job & out) const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		std::map<uint64_t, Job>::const_iterator itr = jobs_.find(id);
+		if (itr == jobs_.end())
+			return false;
+		out = itr->second;
+		return true;
+	}
+
+	// The D-Bus call is being made.
+	void running(uint64_t id, time_t now = time(0)) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (Job * job = pending(id))
+			set(*job, "running", now);
+	}
+
+	// NetworkManager took the request; activeConnection is the object
+	// whose state the job follows from now on.
+	void started(uint64_t id, const std::string & activeConnection, time_t now = time(0)) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (Job * job = pending(id)) {
+			job->activeConnection = activeConnection;
+			set(*job, job->deactivating() ? "deactivating" : "activating", now);
+		}
+	}
+
+	void failed(uint64_t id, const std::string & error, time_t now = time(0)) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (Job * job = pending(id))
+			fail(*job, error, now);
+	}
+
+	// An ActiveConnection changed state; every unfinished job on it
+	// follows.
+	void activeState(const std::string & activeConnection, uint32_t state, uint32_t reason = 0, time_t now = time(0)) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (std::map<uint64_t, Job>::iterator itr = jobs_.begin(); itr != jobs_.end(); ++itr) {
+			Job & job = itr->second;
+			if (job.done || job.activeConnection != activeConnection || job.state == "queued" || job.state == "running")
+				continue;
+			if (state == DEACTIVATED && !job.deactivating())
+				fail(job, "activation failed, reason " + std::to_string(reason), now);
+			else if (state == DEACTIVATED || (state == ACTIVATED && !job.deactivating()))
+				finish(job, stateName(state), now);
+			else if (state == ACTIVATING || state == DEACTIVATING)
+				set(job, stateName(state), now);
+		}
+	}
+
+	// Whether any unfinished job still follows activeConnection.
+	bool watched(const std::string & activeConnection) const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (std::map<uint64_t, Job>::const_iterator itr = jobs_.begin(); itr != jobs_.end(); ++itr)
+			if (!itr->second.done && itr->second.activeConnection == activeConnection)
+				return true;
+		return false;
+	}
+
+	static const char * stateName(uint32_t state) {
+		static const char * const names[] = { "unknown", "activating", "activated", "deactivating", "deactivated" };
+		return state <= DEACTIVATED ? names[state] : "unknown";
+	}
+
+private:
+	Job * pending(uint64_t id) {
+		std::map<uint64_t, Job>::iterator itr = jobs_.find(id);
+		return itr == jobs_.end() || itr->second.done ? 0 : &itr->second;
+	}
+
+	static void set(Job & job, const std::string & state, time_t now) {
+		job.state = state;
+		job.updated = now;
+	}
+
+	static void finish(Job & job, const std::string & state, time_t now) {
+		set(job, state, now);
+		job.done = true;
+	}
+
+	static void fail(Job & job, const std::string & error, time_t now) {
+		finish(job, "failed", now);
+		job.error = error;
+	}
+
+	mutable std::mutex mutex_;
+	uint64_t nextId_;
+	std::map<uint64_t, Job> jobs_;
+	std::deque<uint64_t> order_; // creation order, for eviction
+};
+
+// What the connection resources need from the D-Bus side. Each call
+// queues the operation and returns its job id at once.
+class ConnectionControl {
+public:
+	typedef std::map< std::string, std::map<std::string, std::string> > settings_type;
+
+	virtual ~ConnectionControl() {}
+
+	virtual uint64_t activate(const std::string & connection, const std::string & device, const std::string & specificObject) = 0;
+	virtual uint64_t addAndActivate(const settings_type & settings, const std::string & device, const std::string & specificObject) = 0;
+	virtual uint64_t deactivate(const std::string & activeConnection) = 0;
+};
+#endif // JOB_TABLE_H
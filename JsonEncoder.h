@@ -0,0 +1,125 @@
+#ifndef JSON_ENCODER_H
+#define JSON_ENCODER_H
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "FieldProjection.h"
+#include "JsonText.h"
+
+// JSON objects encoded from a member list known at compile time. Each key
+// is a single literal with its quotes, colon and leading comma baked in, so
+// a record is a few appends of fixed-length literals plus value escaping;
+// there is no name lookup or archive dispatch per member.
+//
+// A DTO lists its members once, in an X-macro shared with its cereal
+// serialize(), and encodes itself with:
+//
+//   #define FOO_FIELDS(FIELD) FIELD(a) FIELD(b)
+//   void encodeJson(std::string & out, const FieldSet * fields = 0) const
+//   { jsonObject(out, fields FOO_FIELDS(JSON_FIELD)); }
+//
+// Members may be strings, bools, integers, vectors of these, or other
+// types with an encodeJson(std::string &) member.
+
+template<size_t N, class T>
+struct JsonField {
+	const char (&key)[N]; // ,"name":
+	const T & value;
+
+	static const size_t keyLength = N - 1;
+	static const size_t nameLength = N - 5;
+	const char * name() const { return key + 2; }
+};
+
+template<size_t N, class T>
+JsonField<N, T> jsonField(const char (&key)[N], const T & value)
+{
+	return JsonField<N, T>{key, value};
+}
+
+// X-macro argument: a comma, then the field for member m of *this.
+#define JSON_FIELD(m) , jsonField(",\"" #m "\":", this->m)
+
+inline void encodeJsonValue(std::string & out, const std::string & value)
+{
+	appendJsonString(out, value);
+}
+
+inline void encodeJsonValue(std::string & out, const char * value)
+{
+	appendJsonString(out, value, std::char_traits<char>::length(value));
+}
+
+inline void encodeJsonValue(std::string & out, bool value)
+{
+	if (value)
+		out.append("true", 4);
+	else
+		out.append("false", 5);
+}
+
+template<class T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type
+encodeJsonValue(std::string & out, T value)
+{
+	char digits[24];
+	char * end = digits + sizeof(digits);
+	char * p = end;
+	bool negative = value < 0;
+	typename std::make_unsigned<T>::type n = value;
+	if (negative)
+		n = 0 - n;
+	do {
+		*--p = static_cast<char>('0' + n % 10);
+		n /= 10;
+	} while (n);
+	if (negative)
+		*--p = '-';
+	out.append(p, end - p);
+}
+
+template<class T>
+auto encodeJsonValue(std::string & out, const T & value) -> decltype(value.encodeJson(out), void())
+{
+	value.encodeJson(out);
+}
+
+template<class T>
+void encodeJsonValue(std::string & out, const std::vector<T> & values)
+{
+	out += '[';
+	for (size_t i = 0; i < values.size(); ++i) {
+		if (i)
+			out += ',';
+		encodeJsonValue(out, values[i]);
+	}
+	out += ']';
+}
+
+inline void encodeJsonMembers(std::string &, const FieldSet *, bool) {}
+
+template<size_t N, class T, class ... Rest>
+void encodeJsonMembers(std::string & out, const FieldSet * fields, bool first,
+                       const JsonField<N, T> & field, const Rest & ... rest)
+{
+	typedef JsonField<N, T> field_type;
+	if (!fields || fields->contains(field.name(), field_type::nameLength)) {
+		// The first member takes the key without its comma.
+		out.append(field.key + first, field_type::keyLength - first);
+		encodeJsonValue(out, field.value);
+		first = false;
+	}
+	encodeJsonMembers(out, fields, first, rest...);
+}
+
+// {"a":...,"b":...} for the listed members, or only those in fields.
+template<class ... Fields>
+void jsonObject(std::string & out, const FieldSet * fields, const Fields & ... members)
+{
+	out += '{';
+	encodeJsonMembers(out, fields, true, members...);
+	out += '}';
+}
+#endif // JSON_ENCODER_H
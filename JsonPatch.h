@@ -0,0 +1,24 @@
+#ifndef JSON_PATCH_H
+#define JSON_PATCH_H
+
+#include <string>
+
+#include "JsonEncoder.h"
+#include "JsonText.h"
+
+// RFC 6902 JSON Patch operations, appended to an array opened with '['.
+// Paths are literal JSON pointers; member names need no ~0/~1 escaping.
+template<size_t N, class T>
+void appendJsonPatchReplace(std::string & out, const char (&path)[N], const T & value)
+{
+	if (out.empty() || out[out.size() - 1] != '[')
+		out += ',';
+	static const char op[] = "{\"op\":\"replace\",\"path\":";
+	static const char valueKey[] = ",\"value\":";
+	out.append(op, sizeof(op) - 1);
+	appendJsonString(out, path, N - 1);
+	out.append(valueKey, sizeof(valueKey) - 1);
+	encodeJsonValue(out, value);
+	out += '}';
+}
+#endif // JSON_PATCH_H
@@ -0,0 +1,38 @@
+#ifndef JSON_TEXT_H
+#define JSON_TEXT_H
+
+#include <string>
+
+// Append s to out as a quoted JSON string.
+inline void appendJsonString(std::string & out, const char * s, size_t length)
+{
+	static const char digits[] = "0123456789abcdef";
+	out += '"';
+	const char * run = s;
+	for (const char * p = s; p != s + length; ++p) {
+		unsigned char c = static_cast<unsigned char>(*p);
+		if (c >= 0x20 && c != '"' && c != '\\')
+			continue;
+		out.append(run, p - run);
+		run = p + 1;
+		switch (c) {
+		case '"': out += "\\\""; break;
+		case '\\': out += "\\\\"; break;
+		case '\n': out += "\\n"; break;
+		case '\r': out += "\\r"; break;
+		case '\t': out += "\\t"; break;
+		default:
+			out += "\\u00";
+			out += digits[c >> 4];
+			out += digits[c & 0xf];
+		}
+	}
+	out.append(run, s + length - run);
+	out += '"';
+}
+
+inline void appendJsonString(std::string & out, const std::string & s)
+{
+	appendJsonString(out, s.data(), s.size());
+}
+#endif // JSON_TEXT_H
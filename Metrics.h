@@ -0,0 +1,379 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <unistd.h>
+
+#include "Tracer.h"
+
+// Latency buckets with a constant relative error, HDR style: two per
+// octave (16us, 24us, 32us, 48us, ...), up to 50s, then +Inf.
+struct LatencyBuckets {
+	enum { COUNT = 45 }; // the last one is +Inf
+
+	// The bucket of a latency in microseconds.
+	static unsigned index(uint64_t micros) {
+		uint64_t x = micros ? micros - 1 : 0;
+		uint64_t m = x >> 4;
+		if (m == 0)
+			return 0;
+		unsigned octave = 63 - __builtin_clzll(m);
+		unsigned i = 2 * octave + (x < (uint64_t(24) << octave) ? 1 : 2);
+		return i < COUNT - 1 ? i : COUNT - 1;
+	}
+
+	// Inclusive upper bound of bucket i in microseconds; 0 for +Inf.
+	static uint64_t upper(unsigned i) {
+		if (i >= COUNT - 1)
+			return 0;
+		if (i == 0)
+			return 16;
+		return (i % 2 ? uint64_t(24) : uint64_t(32)) << ((i - 1) / 2);
+	}
+};
+
+// Process-wide request, D-Bus and cache counters in Prometheus text format.
+// Every thread counts into a shard of its own with plain relaxed stores,
+// no lock and no shared cache line on the request path; render() sums the
+// shards at scrape time. Labels are fixed enumerations so a shard is a
+// flat block of counters.
+//
+// The counts are this process's. Where several FastCGI processes share the
+// listen socket, a scrape reaches any one of them, so every series then
+// carries a worker label (see workerLabel()) and no process's counters are
+// mistaken for another's.
+class Metrics {
+public:
+	typedef std::chrono::steady_clock clock;
+
+	enum Route { ROOT, EVENTS, DEVICES, CONNECTIONS, CONNECTIVITY, JOBS, BATCH, METRICS, TRACE, OTHER, ROUTES };
+	enum DBusCall { NM_GET_ALL, GET_DEVICES, DEVICE_GET_ALL, CHECK_CONNECTIVITY, ACTIVATE_CONNECTION,
+	                ADD_AND_ACTIVATE_CONNECTION, DEACTIVATE_CONNECTION, DBUS_CALLS };
+	enum Cache { RENDER_CACHE, DEVICE_CACHE, CONNECTIVITY_CACHE, CACHES };
+
+	static Metrics & instance() {
+		static Metrics metrics(workerLabel());
+		return metrics;
+	}
+
+	// worker, if not empty, labels every series.
+	explicit Metrics(const std::string & worker = std::string()): id_(nextId()),
+	labels_(worker.empty() ? std::string() : "worker=\"" + worker + "\",") {}
+
+	// The prefork slot (FCGIAPP_WORKER), or the pid in a process that
+	// follows a SharedSnapshot without one, e.g. under spawn-fcgi -F; empty
+	// when this process is the only one serving.
+	static std::string workerLabel() {
+		if (const char * slot = getenv("FCGIAPP_WORKER"))
+			return slot;
+		const char * shm = getenv("FCGIAPP_SHM");
+		const char * updater = getenv("FCGIAPP_SHM_UPDATER");
+		if (shm && !(updater && atoi(updater)))
+			return std::to_string(getpid());
+		return std::string();
+	}
+
+	~Metrics() {
+		for (size_t i = 0; i < shards_.size(); ++i)
+			delete shards_[i];
+	}
+
+	Metrics(const Metrics &) = delete;
+	Metrics & operator=(const Metrics &) = delete;
+
+	// The route of a request by the first segment of its path.
+	static Route route(const std::string & segment) {
+		for (int r = ROOT + 1; r < OTHER; ++r)
+			if (segment == routeName(Route(r)))
+				return Route(r);
+		return segment.empty() ? ROOT : OTHER;
+	}
+
+	void started(Route route) {
+		add(shard().started[route]);
+	}
+
+	// A finished request; status 0 if none was sent.
+	void finished(Route route, int status, clock::duration elapsed) {
+		Shard & s = shard();
+		add(s.finished[route]);
+		add(s.requests[route][statusIndex(status)]);
+		record(s.latency[route], elapsed);
+	}
+
+	void cache(Cache cache, bool hit) {
+		add(shard().cache[cache][hit ? 1 : 0]);
+	}
+
+	// Times a D-Bus call from construction to destruction; the call
+	// counts as failed if an exception is leaving the scope. It is traced
+	// too, in category "dbus".
+	class DBusTimer {
+	public:
+		explicit DBusTimer(DBusCall call, Metrics & metrics = Metrics::instance()):
+		metrics_(metrics), call_(call), start_(clock::now()), uncaught_(std::uncaught_exception()),
+		span_(dbusCallName(call), "dbus") {
+			add(metrics_.shard().dbusStarted[call_]);
+		}
+
+		~DBusTimer() {
+			Shard & s = metrics_.shard();
+			add(s.dbusFinished[call_]);
+			add(s.dbusFailed[call_], std::uncaught_exception() && !uncaught_ ? 1 : 0);
+			record(s.dbusLatency[call_], clock::now() - start_);
+		}
+
+	private:
+		Metrics & metrics_;
+		DBusCall call_;
+		clock::time_point start_;
+		bool uncaught_;
+		Tracer::Span span_;
+	};
+
+	// Prometheus text exposition format 0.0.4. Series that never counted
+	// anything are left out.
+	std::string render() const {
+		Shard total;
+		uint64_t inFlight[ROUTES] = {}, dbusInFlight[DBUS_CALLS] = {};
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (size_t i = 0; i < shards_.size(); ++i) {
+				const Shard & s = *shards_[i];
+				total.merge(s);
+				// Per shard, as its thread may start and finish between the
+				// two loads; a finish seen before its start counts as none.
+				for (int r = 0; r < ROUTES; ++r)
+					inFlight[r] += pending(s.started[r], s.finished[r]);
+				for (int c = 0; c < DBUS_CALLS; ++c)
+					dbusInFlight[c] += pending(s.dbusStarted[c], s.dbusFinished[c]);
+			}
+		}
+
+		std::string out;
+		out += "# HELP fcgiapp_requests_total Requests answered, by route and status.\n"
+		       "# TYPE fcgiapp_requests_total counter\n";
+		for (int r = 0; r < ROUTES; ++r)
+			for (int i = 0; i < STATUSES; ++i)
+				if (uint64_t n = total.requests[r][i].load())
+					line(out, "fcgiapp_requests_total", n, "route=\"%s\",status=\"%s\"", routeName(Route(r)), statusName(i));
+		out += "# HELP fcgiapp_requests_in_flight Requests being processed, by route.\n"
+		       "# TYPE fcgiapp_requests_in_flight gauge\n";
+		for (int r = 0; r < ROUTES; ++r)
+			if (total.started[r].load())
+				line(out, "fcgiapp_requests_in_flight", inFlight[r], "route=\"%s\"", routeName(Route(r)));
+		out += "# HELP fcgiapp_request_duration_seconds Time from accept to the end of the response, by route.\n"
+		       "# TYPE fcgiapp_request_duration_seconds histogram\n";
+		for (int r = 0; r < ROUTES; ++r)
+			histogram(out, "fcgiapp_request_duration_seconds", "route", routeName(Route(r)), total.latency[r]);
+
+		out += "# HELP fcgiapp_dbus_calls_total Calls to NetworkManager, by call and result.\n"
+		       "# TYPE fcgiapp_dbus_calls_total counter\n";
+		for (int c = 0; c < DBUS_CALLS; ++c) {
+			uint64_t calls = total.dbusFinished[c].load(), failed = total.dbusFailed[c].load();
+			if (calls) {
+				line(out, "fcgiapp_dbus_calls_total", calls - failed, "call=\"%s\",result=\"%s\"", dbusCallName(DBusCall(c)), "ok");
+				line(out, "fcgiapp_dbus_calls_total", failed, "call=\"%s\",result=\"%s\"", dbusCallName(DBusCall(c)), "error");
+			}
+		}
+		out += "# HELP fcgiapp_dbus_calls_in_flight Calls to NetworkManager waiting for a reply.\n"
+		       "# TYPE fcgiapp_dbus_calls_in_flight gauge\n";
+		for (int c = 0; c < DBUS_CALLS; ++c)
+			if (total.dbusStarted[c].load())
+				line(out, "fcgiapp_dbus_calls_in_flight", dbusInFlight[c], "call=\"%s\"", dbusCallName(DBusCall(c)));
+		out += "# HELP fcgiapp_dbus_call_duration_seconds Round trip of calls to NetworkManager, by call.\n"
+		       "# TYPE fcgiapp_dbus_call_duration_seconds histogram\n";
+		for (int c = 0; c < DBUS_CALLS; ++c)
+			histogram(out, "fcgiapp_dbus_call_duration_seconds", "call", dbusCallName(DBusCall(c)), total.dbusLatency[c]);
+
+		out += "# HELP fcgiapp_cache_lookups_total Lookups in the response and NetworkManager caches, by result.\n"
+		       "# TYPE fcgiapp_cache_lookups_total counter\n";
+		for (int c = 0; c < CACHES; ++c) {
+			uint64_t misses = total.cache[c][0].load(), hits = total.cache[c][1].load();
+			if (hits + misses) {
+				line(out, "fcgiapp_cache_lookups_total", hits, "cache=\"%s\",result=\"%s\"", cacheName(Cache(c)), "hit");
+				line(out, "fcgiapp_cache_lookups_total", misses, "cache=\"%s\",result=\"%s\"", cacheName(Cache(c)), "miss");
+			}
+		}
+		return out;
+	}
+
+	static const char * routeName(Route route) {
+		static const char * const names[] = { "root", "events", "devices", "connections", "connectivity", "jobs", "batch", "metrics", "trace", "other" };
+		return names[route];
+	}
+
+private:
+	enum { STATUSES = 18 };
+
+	typedef std::atomic<uint64_t> Counter;
+
+	struct Histogram {
+		Counter buckets[LatencyBuckets::COUNT];
+		Counter micros;
+	};
+
+	struct Shard {
+		Counter requests[ROUTES][STATUSES];
+		Counter started[ROUTES];
+		Counter finished[ROUTES];
+		Histogram latency[ROUTES];
+		Counter dbusStarted[DBUS_CALLS];
+		Counter dbusFinished[DBUS_CALLS];
+		Counter dbusFailed[DBUS_CALLS];
+		Histogram dbusLatency[DBUS_CALLS];
+		Counter cache[CACHES][2]; // miss, hit
+
+		Shard() { clear(reinterpret_cast<Counter *>(this), sizeof(*this) / sizeof(Counter)); }
+
+		void merge(const Shard & other) {
+			Counter * to = reinterpret_cast<Counter *>(this);
+			const Counter * from = reinterpret_cast<const Counter *>(&other);
+			for (size_t i = 0; i < sizeof(*this) / sizeof(Counter); ++i)
+				add(to[i], from[i].load(std::memory_order_relaxed));
+		}
+
+		static void clear(Counter * counters, size_t n) {
+			for (size_t i = 0; i < n; ++i)
+				counters[i].store(0, std::memory_order_relaxed);
+		}
+	};
+
+	static_assert(sizeof(Shard) % sizeof(Counter) == 0, "a Shard is a flat block of counters");
+
+	// Only the owning thread writes a shard, so a relaxed load and store
+	// do where a shared counter would need a locked read-modify-write.
+	static void add(Counter & counter, uint64_t n = 1) {
+		counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+
+	// started - finished, finished loaded first.
+	static uint64_t pending(const Counter & started, const Counter & finished) {
+		uint64_t done = finished.load(std::memory_order_relaxed);
+		uint64_t begun = started.load(std::memory_order_relaxed);
+		return begun > done ? begun - done : 0;
+	}
+
+	static void record(Histogram & h, clock::duration elapsed) {
+		uint64_t micros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+		add(h.buckets[LatencyBuckets::index(micros)]);
+		add(h.micros, micros);
+	}
+
+	// This thread's shard of this instance, created on first use. Shards
+	// live as long as the instance, so counts survive their threads.
+	Shard & shard() {
+		struct Owned {
+			uint64_t id;
+			Shard * shard;
+		};
+		static thread_local std::vector<Owned> owned;
+		for (size_t i = 0; i < owned.size(); ++i)
+			if (owned[i].id == id_)
+				return *owned[i].shard;
+		Shard * s = new Shard();
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			shards_.push_back(s);
+		}
+		Owned o = { id_, s };
+		owned.push_back(o);
+		return *s;
+	}
+
+	static uint64_t nextId() {
+		static std::atomic<uint64_t> id(0);
+		return ++id;
+	}
+
+	static const int * statusCodes() {
+		static const int codes[STATUSES] = { 0, 200, 201, 202, 204, 206, 304, 400, 403, 404, 405, 406, 409, 412, 500, 501, 503, -1 };
+		return codes;
+	}
+
+	static int statusIndex(int status) {
+		for (int i = 0; i < STATUSES - 1; ++i)
+			if (statusCodes()[i] == status)
+				return i;
+		return STATUSES - 1;
+	}
+
+	static const char * statusName(int index) {
+		static char names[STATUSES][8];
+		static std::once_flag once;
+		std::call_once(once, [] {
+			for (int i = 0; i < STATUSES; ++i)
+				snprintf(names[i], sizeof(names[i]), "%d", statusCodes()[i]);
+			snprintf(names[0], sizeof(names[0]), "none");
+			snprintf(names[STATUSES - 1], sizeof(names[STATUSES - 1]), "other");
+		});
+		return names[index];
+	}
+
+	static const char * dbusCallName(DBusCall call) {
+		static const char * const names[] = { "GetAll", "GetDevices", "Device.GetAll", "CheckConnectivity",
+		                                      "ActivateConnection", "AddAndActivateConnection", "DeactivateConnection" };
+		return names[call];
+	}
+
+	static const char * cacheName(Cache cache) {
+		static const char * const names[] = { "render", "devices", "connectivity" };
+		return names[cache];
+	}
+
+	// name{labels} value, the labels formatted from a and b.
+	void line(std::string & out, const char * name, uint64_t value, const char * labels, const char * a, const char * b = "") const {
+		char text[256];
+		int n = snprintf(text, sizeof(text), labels, a, b);
+		out += name;
+		out += '{';
+		out += labels_;
+		out.append(text, n < int(sizeof(text)) ? n : sizeof(text) - 1);
+		out += "} ";
+		out += std::to_string(value);
+		out += '\n';
+	}
+
+	void histogram(std::string & out, const char * name, const char * label, const char * value, const Histogram & h) const {
+		uint64_t count = 0;
+		for (unsigned i = 0; i < LatencyBuckets::COUNT; ++i)
+			count += h.buckets[i].load();
+		if (!count)
+			return;
+		char text[160];
+		uint64_t cumulative = 0;
+		for (unsigned i = 0; i < LatencyBuckets::COUNT; ++i) {
+			cumulative += h.buckets[i].load();
+			uint64_t upper = LatencyBuckets::upper(i);
+			if (upper)
+				snprintf(text, sizeof(text), "%s_bucket{%s%s=\"%s\",le=\"%.9g\"} ", name, labels_.c_str(), label, value, upper / 1e6);
+			else
+				snprintf(text, sizeof(text), "%s_bucket{%s%s=\"%s\",le=\"+Inf\"} ", name, labels_.c_str(), label, value);
+			out += text;
+			out += std::to_string(cumulative);
+			out += '\n';
+		}
+		snprintf(text, sizeof(text), "%s_sum{%s%s=\"%s\"} %.6f\n", name, labels_.c_str(), label, value, h.micros.load() / 1e6);
+		out += text;
+		snprintf(text, sizeof(text), "%s_count{%s%s=\"%s\"} ", name, labels_.c_str(), label, value);
+		out += text;
+		out += std::to_string(count);
+		out += '\n';
+	}
+
+	const uint64_t id_;
+	const std::string labels_; // worker="...", or empty
+	mutable std::mutex mutex_;
+	std::vector<Shard *> shards_;
+};
+#endif // METRICS_H
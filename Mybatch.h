@@ -0,0 +1,146 @@
+#ifndef MYBATCH_H
+#define MYBATCH_H
+
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <restcgi/resource.h>
+#include <restcgi/rest.h>
+#include <restcgi/endpoint.h>
+#include <restcgi/env.h>
+#include <restcgi/method.h>
+#include <restcgi/hdr.h>
+#include <restcgi/exception.h>
+
+#include <cereal/external/rapidjson/document.h>
+
+#include "CgiResponse.h"
+#include "ETag.h"
+#include "Myevents.h"
+#include "Mytrace.h"
+
+using namespace restcgi;
+
+// Several GETs in one round trip. The paths come from repeated "path" query
+// parameters (GET /batch?path=/&path=/devices) or from a JSON array of
+// strings in a POST body. Each one goes through rest::locate() and
+// rest::apply() on a fresh root, exactly as if it had been requested on its
+// own, with the batch request's Accept and conditional headers, and the
+// responses are returned as one JSON document:
+//
+//   {"responses": [{"path": "/", "status": 200, "etag": "...", "body": {...}}, ...]}
+//
+// If-None-Match may list the tags of several sub-responses; each one that
+// still matches comes back as a 304 without a body.
+class Mybatch : public restcgi::resource {
+public:
+	typedef std::function<resource::pointer()> root_factory;
+
+	static const size_t MAX_PATHS = 32;
+
+	Mybatch(root_factory root):
+	restcgi::resource (method_e::GET | method_e::POST), root_(root) {
+
+	}
+
+    version read(bool veronly) {
+		std::vector<std::string> paths;
+		const uripp::query & query = uri_info().query();
+		for (uripp::query::const_iterator itr = query.begin(); itr != query.end(); ++itr)
+			if (itr->first == "path")
+				paths.push_back(itr->second);
+		run(paths);
+    	return version(version_tag(strongETag(body_)));
+    }
+
+	// POST carries the paths in the body; it reads nothing and creates
+	// nothing, so the default create_child() flow does not apply.
+	void post_method() {
+		icontent::pointer ic = method()->icontent();
+		std::string text((std::istreambuf_iterator<char>(ic->istream())), std::istreambuf_iterator<char>());
+
+		rapidjson::Document document;
+		document.Parse<0>(text.c_str());
+		if (document.HasParseError() || !document.IsArray())
+			throw bad_request("batch body must be a JSON array of paths");
+		std::vector<std::string> paths;
+		for (rapidjson::SizeType i = 0; i < document.Size(); ++i) {
+			if (!document[i].IsString())
+				throw bad_request("batch body must be a JSON array of paths");
+			paths.push_back(document[i].GetString());
+		}
+		run(paths);
+
+		status_code_e sc = status_code_e::OK;
+		response_hdr rh;
+		content_hdr ch;
+		on_responding(sc, rh, ch);
+		write(method()->respond(ch, sc, rh));
+	}
+
+    void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
+        ch.content_type("application/json");
+        ch.content_length(body_.length());
+    }
+
+    void write(ocontent::pointer oc) {
+        *oc << body_;
+    }
+
+private:
+	void run(const std::vector<std::string> & paths) {
+		if (paths.empty())
+			throw bad_request("batch needs at least one path");
+		if (paths.size() > MAX_PATHS)
+			throw bad_request("batch is limited to 32 paths");
+
+		body_ = "{\"responses\": [";
+		for (size_t i = 0; i < paths.size(); ++i) {
+			if (i)
+				body_ += ", ";
+			get(paths[i]).appendJson(body_, paths[i]);
+		}
+		body_ += "]}";
+	}
+
+	// One internal GET, through the same locate/apply path as a real one.
+	CgiResponse get(const std::string & target) {
+		std::string::size_type q = target.find('?');
+		restcgi::env::map_type vars;
+		vars["REQUEST_METHOD"] = "GET";
+		vars["PATH_INFO"] = target.substr(0, q);
+		vars["QUERY_STRING"] = q == std::string::npos ? std::string() : target.substr(q + 1);
+		vars["SCRIPT_URI"] = method()->env().script_uri();
+		static const char * const forwarded[] = { "HTTP_ACCEPT", "HTTP_IF_NONE_MATCH", "HTTP_IF_MODIFIED_SINCE", "HTTP_HOST", 0 };
+		for (const char * const * name = forwarded; *name; ++name) {
+			std::string value;
+			if (method()->env().find(*name, value))
+				vars[*name] = value;
+		}
+		restcgi::env e(vars);
+
+		std::istringstream is;
+		std::ostringstream os;
+		restcgi::endpoint::method_pointer m = restcgi::endpoint::create(e, is, os)->receive();
+		resource::pointer r = root_();
+		try {
+			r = restcgi::rest::locate(m, r);
+			// Event streams never finish, trace recordings hold the worker
+			// for seconds, and batches would recurse.
+			if (dynamic_cast<Mybatch *>(r.get()) || dynamic_cast<Myevents *>(r.get()) || dynamic_cast<Mytrace *>(r.get()))
+				throw bad_request("resource cannot be part of a batch: " + target);
+			restcgi::rest::apply(m, r);
+		} catch (...) {
+			restcgi::rest::on_exception(m, sc_ctmpls());
+		}
+		return CgiResponse::parse(os.str());
+	}
+
+	root_factory root_;
+	std::string body_;
+};
+#endif //MYBATCH_H
@@ -0,0 +1,209 @@
+#ifndef MYCONNECTIONS_H
+#define MYCONNECTIONS_H
+
+#include <cstdlib>
+#include <iterator>
+#include <string>
+
+#include <restcgi/resource.h>
+#include <restcgi/env.h>
+#include <restcgi/method.h>
+#include <restcgi/hdr.h>
+#include <restcgi/exception.h>
+
+#include <cereal/external/rapidjson/document.h>
+
+#include "AppContext.h"
+#include "JobTable.h"
+
+using namespace restcgi;
+
+// GET /jobs/{id}: where an accepted (de)activation has got to. Clients
+// poll it (Retry-After says how often) until "done" is true.
+class Myjob : public restcgi::resource {
+public:
+	Myjob(AppContext & context, uint64_t id):
+	restcgi::resource (method_e::GET | method_e::HEAD), context_(context), id_(id) {
+
+	}
+
+    version read(bool veronly) {
+		if (!context_.jobs.find(id_, job_))
+			throw not_found("no such job");
+		job_.encodeJson(body_);
+    	return version();
+    }
+
+    void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
+        rh.cache_control("no-cache");
+        if (!job_.done)
+        	rh.retry_after(1);
+        ch.content_type("application/json");
+        ch.content_length(body_.length());
+    }
+
+    void write(ocontent::pointer oc) {
+        *oc << body_;
+    }
+
+    // The job URL relative to the application, for Location headers.
+    static std::string href(const method_pointer & m, uint64_t id) {
+		std::string base = m->env().script_uri();
+		if (!base.empty() && base[base.size() - 1] == '/')
+			base.erase(base.size() - 1);
+		return base + "/jobs/" + std::to_string(id);
+    }
+
+    // 202 Accepted pointing at job id.
+    static void accepted(const method_pointer & m, AppContext & context, uint64_t id,
+                         status_code_e& sc, response_hdr& rh, content_hdr& ch, std::string & body) {
+		Job job;
+		context.jobs.find(id, job);
+		body.clear();
+		job.encodeJson(body);
+		sc = status_code_e::ACCEPTED;
+		rh.location(href(m, id));
+		rh.cache_control("no-cache");
+		ch.content_type("application/json");
+		ch.content_length(body.length());
+    }
+
+private:
+	AppContext & context_;
+	uint64_t id_;
+	Job job_;
+	std::string body_;
+};
+
+// /jobs: only its members are addressable.
+class Myjobs : public restcgi::resource {
+public:
+	Myjobs(AppContext & context):
+	restcgi::resource (method_e::GET), context_(context) {
+
+	}
+
+    version read(bool veronly) {
+		throw not_found("jobs are addressed by id");
+    }
+
+    pointer locate(uri_path_type& path) {
+		std::string id = path.front();
+		path.pop_front();
+		if (id.empty() || id.size() > 19 || id.find_first_not_of("0123456789") != std::string::npos)
+			throw not_found("no such job: " + id);
+		return pointer(new Myjob(context_, strtoull(id.c_str(), 0, 10)));
+    }
+
+private:
+	AppContext & context_;
+};
+
+// DELETE /connections/{n}: deactivate ActiveConnection/{n}. Answers 202
+// with the job at once; NetworkManager finishes in the background.
+class Myactiveconnection : public restcgi::resource {
+public:
+	Myactiveconnection(AppContext & context, const std::string & id):
+	restcgi::resource (method_e::DEL), context_(context), id_(id) {
+
+	}
+
+    void del() {
+		if (id_.empty() || id_.find_first_not_of("0123456789") != std::string::npos)
+			throw not_found("no such active connection: " + id_);
+		jobId_ = context_.connections->deactivate("/org/freedesktop/NetworkManager/ActiveConnection/" + id_);
+    }
+
+    void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
+		Myjob::accepted(method(), context_, jobId_, sc, rh, ch, body_);
+    }
+
+    void write(ocontent::pointer oc) {
+        *oc << body_;
+    }
+
+private:
+	AppContext & context_;
+	std::string id_;
+	uint64_t jobId_ = 0;
+	std::string body_;
+};
+
+// POST /connections: activate a connection, answered with 202 and a job.
+//
+//   {"connection": "/org/freedesktop/NetworkManager/Settings/3", "device": "...", "specific_object": "..."}
+//   {"settings": {"connection": {"id": "lab", "type": "802-3-ethernet"}}, "device": "..."}
+//
+// The first activates a saved connection (ActivateConnection), the second
+// adds one from string-valued settings and activates it
+// (AddAndActivateConnection). device and specific_object default to "/".
+class Myconnections : public restcgi::resource {
+public:
+	Myconnections(AppContext & context):
+	restcgi::resource (method_e::POST), context_(context) {
+
+	}
+
+	// Nothing is created here yet, so the default create_child() flow
+	// (201 with Content-Location) does not apply.
+	void post_method() {
+		icontent::pointer ic = method()->icontent();
+		std::string text((std::istreambuf_iterator<char>(ic->istream())), std::istreambuf_iterator<char>());
+
+		rapidjson::Document document;
+		document.Parse<0>(text.c_str());
+		if (document.HasParseError() || !document.IsObject())
+			throw bad_request("body must be a JSON object");
+		std::string device = member(document, "device");
+		std::string specificObject = member(document, "specific_object");
+		uint64_t id;
+		if (document.HasMember("settings")) {
+			const rapidjson::Value & settings = document["settings"];
+			if (!settings.IsObject())
+				throw bad_request("settings must be an object of setting groups");
+			ConnectionControl::settings_type groups;
+			for (rapidjson::Value::ConstMemberIterator group = settings.MemberBegin(); group != settings.MemberEnd(); ++group) {
+				if (!group->value.IsObject())
+					throw bad_request("settings must be an object of setting groups");
+				for (rapidjson::Value::ConstMemberIterator itr = group->value.MemberBegin(); itr != group->value.MemberEnd(); ++itr) {
+					if (!itr->value.IsString())
+						throw bad_request("setting values must be strings");
+					groups[group->name.GetString()][itr->name.GetString()] = itr->value.GetString();
+				}
+			}
+			id = context_.connections->addAndActivate(groups, device, specificObject);
+		} else {
+			std::string connection = member(document, "connection");
+			if (connection.empty())
+				throw bad_request("connection or settings is required");
+			id = context_.connections->activate(connection, device, specificObject);
+		}
+
+		status_code_e sc = status_code_e::OK;
+		response_hdr rh;
+		content_hdr ch;
+		Myjob::accepted(method(), context_, id, sc, rh, ch, body_);
+		*method()->respond(ch, sc, rh) << body_;
+	}
+
+    pointer locate(uri_path_type& path) {
+		std::string id = path.front();
+		path.pop_front();
+		return pointer(new Myactiveconnection(context_, id));
+    }
+
+private:
+	// An optional string member; anything else is a bad request.
+	static std::string member(const rapidjson::Document & document, const char * name) {
+		if (!document.HasMember(name))
+			return std::string();
+		const rapidjson::Value & value = document[name];
+		if (!value.IsString())
+			throw bad_request(std::string(name) + " must be a string");
+		return value.GetString();
+	}
+
+	AppContext & context_;
+	std::string body_;
+};
+#endif //MYCONNECTIONS_H
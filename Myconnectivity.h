@@ -0,0 +1,69 @@
+#ifndef MYCONNECTIVITY_H
+#define MYCONNECTIVITY_H
+
+#include <string>
+
+#include <restcgi/resource.h>
+#include <restcgi/method.h>
+#include <restcgi/hdr.h>
+#include <restcgi/exception.h>
+
+#include "AppContext.h"
+#include "ConnectivityCache.h"
+#include "ETag.h"
+#include "JsonEncoder.h"
+#include "Metrics.h"
+
+using namespace restcgi;
+
+// GET /connectivity: {"connectivity": "full", "state": 4, "checked": <time_t>}
+// from the ConnectivityCache, never from NetworkManager directly. max-age
+// is the TTL and Age the verdict's age, so nginx and clients can cache it
+// for as long as the cache itself would.
+class Myconnectivity : public restcgi::resource {
+public:
+	Myconnectivity(AppContext & context):
+	restcgi::resource (method_e::GET | method_e::HEAD), context_(context) {
+
+	}
+
+    version read(bool veronly) {
+		if (!context_.connectivity)
+			throw service_unavailable("connectivity checks not available", 30);
+		now_ = time(0);
+		result_ = context_.connectivity->get(now_);
+		Metrics::instance().cache(Metrics::CONNECTIVITY_CACHE,
+		                          result_.checked && now_ - result_.checked < context_.connectivity->ttl().count());
+		if (result_.checked == 0)
+			throw service_unavailable("connectivity not checked yet", 1);
+
+		body_.append("{\"connectivity\":", 16);
+		encodeJsonValue(body_, ConnectivityCache::name(result_.state));
+		body_.append(",\"state\":", 9);
+		encodeJsonValue(body_, result_.state);
+		body_.append(",\"checked\":", 11);
+		encodeJsonValue(body_, static_cast<int64_t>(result_.checked));
+		body_ += '}';
+    	return version(version_tag(strongETag(body_)), date_time(result_.checked));
+    }
+
+    void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
+		// Caches count max-age from the Age they are given, so the full TTL
+		// with the verdict's age leaves them exactly what is left of it.
+        rh.cache_control("max-age=" + std::to_string(context_.connectivity->ttl().count()));
+        rh.age(static_cast<size_t>(now_ > result_.checked ? now_ - result_.checked : 0));
+        ch.content_type("application/json");
+        ch.content_length(body_.length());
+    }
+
+    void write(ocontent::pointer oc) {
+        *oc << body_;
+    }
+
+private:
+	AppContext & context_;
+	time_t now_ = 0;
+	ConnectivityCache::Result result_ = ConnectivityCache::Result();
+	std::string body_;
+};
+#endif //MYCONNECTIVITY_H
@@ -0,0 +1,220 @@
+#ifndef MYDEVICES_H
+#define MYDEVICES_H
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <restcgi/resource.h>
+#include <restcgi/method.h>
+#include <restcgi/hdr.h>
+#include <restcgi/exception.h>
+
+#include "AppContext.h"
+#include "DeviceTable.h"
+#include "FieldProjection.h"
+#include "JsonText.h"
+
+using namespace restcgi;
+
+// A follower whose updater's device table outgrew the shared segment
+// serves the last table that fit.
+inline void markDevicesStale(const AppContext & context, response_hdr & rh)
+{
+	if (context.follower && context.follower->devicesStale())
+		rh.warning("110 - \"Response is Stale\"");
+}
+
+// GET /devices/{iface}/ip4config: the device's IPv4 addresses, gateway and
+// name servers; 404 when it has no IPv4 configuration.
+class Myip4config : public restcgi::resource {
+public:
+	Myip4config(AppContext & context, const std::string & interface):
+	restcgi::resource (method_e::GET | method_e::HEAD), context_(context), interface_(interface), device_(0) {
+
+	}
+
+    version read(bool veronly) {
+		reader_.open(context_.devices);
+		const DeviceTable * table = reader_.table();
+		const DeviceInfo * device = table ? table->find(interface_) : 0;
+		if (!device || !device->hasIp4Config)
+			throw not_found("no IPv4 configuration for device: " + interface_);
+		device_ = device;
+    	return version(version_tag(table->etag("ip4config\n" + interface_)), date_time(table->modified()));
+    }
+
+    void render() {
+		device_->ip4config.encodeJson(body_);
+    }
+
+    void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
+        rh.cache_control("no-cache");
+        markDevicesStale(context_, rh);
+        ch.content_type("application/json");
+        if (me() != method_e::HEAD)
+        	ch.content_length(body_.length());
+    }
+
+    void write(ocontent::pointer oc) {
+        *oc << body_;
+    }
+
+private:
+	AppContext & context_;
+	std::string interface_;
+	DeviceState::Reader reader_;
+	const DeviceInfo * device_;
+	std::string body_;
+};
+
+// GET /devices/{iface}: one device, by interface name. Honours ?fields=.
+class Mydevice : public restcgi::resource {
+public:
+	Mydevice(AppContext & context, const std::string & interface):
+	restcgi::resource (method_e::GET | method_e::HEAD), context_(context), interface_(interface), device_(0) {
+
+	}
+
+    version read(bool veronly) {
+		reader_.open(context_.devices);
+		const DeviceTable * table = reader_.table();
+		const DeviceInfo * device = table ? table->find(interface_) : 0;
+		if (!device)
+			throw not_found("no such device: " + interface_);
+		uripp::query::const_iterator itr = method()->uri_query().find("fields");
+		if (itr != method()->uri_query().end())
+			fields_ = FieldSet::parse(itr->second);
+		device_ = device;
+    	return version(version_tag(table->etag("device\n" + interface_ + '\n' + fields_.key())), date_time(table->modified()));
+    }
+
+    void render() {
+		device_->encodeJson(body_, fields_.empty() ? 0 : &fields_);
+    }
+
+    void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
+        rh.cache_control("no-cache");
+        markDevicesStale(context_, rh);
+        ch.content_type("application/json");
+        if (me() != method_e::HEAD)
+        	ch.content_length(body_.length());
+    }
+
+    void write(ocontent::pointer oc) {
+        *oc << body_;
+    }
+
+    pointer locate(uri_path_type& path) {
+		if (path.front() == "ip4config") {
+			path.pop_front();
+			return pointer(new Myip4config(context_, interface_));
+		}
+		return pointer();
+    }
+
+private:
+	AppContext & context_;
+	std::string interface_;
+	DeviceState::Reader reader_;
+	const DeviceInfo * device_;
+	FieldSet fields_;
+	std::string body_;
+};
+
+// GET /devices: the devices in interface-name order, one page at a time.
+//
+//   GET /devices?limit=100                -> {"devices":[...],"total":5000,"next":"eth198"}
+//   GET /devices?limit=100&cursor=eth198  -> the following page
+//
+// The cursor is the last interface of the previous page, so pages stay
+// consistent while devices are added or removed elsewhere in the list.
+// "next" is absent on the last page. Honours ?fields= per device.
+class Mydevices : public restcgi::resource {
+public:
+	static const size_t DEFAULT_LIMIT = 100;
+	static const size_t MAX_LIMIT = 1000;
+
+	Mydevices(AppContext & context):
+	restcgi::resource (method_e::GET | method_e::HEAD), context_(context), limit_(DEFAULT_LIMIT) {
+
+	}
+
+    version read(bool veronly) {
+		reader_.open(context_.devices);
+		const DeviceTable * table = reader_.table();
+		if (!table)
+			throw service_unavailable("device list not available yet", 1);
+
+		const uripp::query & query = method()->uri_query();
+		uripp::query::const_iterator itr = query.find("limit");
+		if (itr != query.end())
+			limit_ = parseLimit(itr->second);
+		itr = query.find("cursor");
+		if (itr != query.end())
+			cursor_ = itr->second;
+		itr = query.find("fields");
+		if (itr != query.end())
+			fields_ = FieldSet::parse(itr->second);
+		// The page is a function of the table and the query, so the tag is
+		// known here; the page itself is only encoded if it is sent.
+		std::string key = "devices\n" + std::to_string(limit_) + '\n' + fields_.key() + '\n' + cursor_;
+    	return version(version_tag(table->etag(key)), date_time(table->modified()));
+    }
+
+    void render() {
+		const DeviceTable * table = reader_.table();
+		std::string next;
+		std::vector<const DeviceInfo *> page = table->page(cursor_, limit_, next);
+		body_.reserve(64 + page.size() * 160);
+		body_.append("{\"devices\":[", 12);
+		for (size_t i = 0; i < page.size(); ++i) {
+			if (i)
+				body_ += ',';
+			page[i]->encodeJson(body_, fields_.empty() ? 0 : &fields_);
+		}
+		body_.append("],\"total\":", 10);
+		encodeJsonValue(body_, table->size());
+		if (!next.empty()) {
+			body_.append(",\"next\":", 8);
+			appendJsonString(body_, next);
+		}
+		body_ += '}';
+    }
+
+    void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
+        rh.cache_control("no-cache");
+        markDevicesStale(context_, rh);
+        ch.content_type("application/json");
+        if (me() != method_e::HEAD)
+        	ch.content_length(body_.length());
+    }
+
+    void write(ocontent::pointer oc) {
+        *oc << body_;
+    }
+
+    pointer locate(uri_path_type& path) {
+		std::string interface = path.front();
+		path.pop_front();
+		return pointer(new Mydevice(context_, interface));
+    }
+
+    static size_t parseLimit(const std::string & s) {
+		if (s.empty() || s.size() > 4 || s.find_first_not_of("0123456789") != std::string::npos)
+			throw bad_request("limit: not a number: " + s);
+		size_t limit = strtoul(s.c_str(), 0, 10);
+		if (limit == 0 || limit > MAX_LIMIT)
+			throw bad_request("limit: must be between 1 and 1000");
+		return limit;
+    }
+
+private:
+	AppContext & context_;
+	DeviceState::Reader reader_;
+	size_t limit_;
+	std::string cursor_;
+	FieldSet fields_;
+	std::string body_;
+};
+#endif //MYDEVICES_H
@@ -0,0 +1,127 @@
+#ifndef MYEVENTS_H
+#define MYEVENTS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ostream>
+#include <vector>
+
+#include <restcgi/resource.h>
+#include <restcgi/method.h>
+#include <restcgi/hdr.h>
+#include <restcgi/exception.h>
+
+#include "AppContext.h"
+
+using namespace restcgi;
+
+// text/event-stream of NetworkManager signals. The request is held open and
+// every event published to the EventRing is pushed as it arrives; a client
+// reconnecting with Last-Event-ID resumes from the ring, or gets a fresh
+// "snapshot" event when the ring no longer reaches back that far.
+class Myevents : public restcgi::resource {
+public:
+	Myevents(AppContext & context, int maxStreams, std::chrono::seconds maxDuration = std::chrono::seconds(300)):
+	restcgi::resource (method_e::GET), context_(context), maxStreams_(maxStreams), maxDuration_(maxDuration),
+	lastEventId_(0), resume_(false), counted_(false) {
+
+	}
+
+	~Myevents() {
+		if (counted_)
+			--streams();
+	}
+
+    // Requests that pin a worker: open event streams and trace recordings
+    // (Mytrace), held to maxEventStreams together.
+    static std::atomic<int> & streams() {
+        static std::atomic<int> count(0);
+        return count;
+    }
+
+    version read(bool veronly) {
+		// Each open stream pins a worker, keep some for ordinary requests.
+		if (++streams() > maxStreams_) {
+			--streams();
+			throw service_unavailable("too many open event streams", 5);
+		}
+		counted_ = true;
+
+		std::string lastEventId;
+		if (method()->request_hdr().find("Last-Event-ID", lastEventId) && !lastEventId.empty()) {
+			lastEventId_ = strtoull(lastEventId.c_str(), 0, 10);
+			resume_ = true;
+		}
+    	return version();
+    }
+
+    void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
+        rh.cache_control("no-cache");
+        rh.insert("X-Accel-Buffering", "no"); // nginx must pass events through as they are written
+        ch.content_type("text/event-stream");
+    }
+
+    void write(ocontent::pointer oc) {
+        std::ostream & os = oc->ostream();
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + maxDuration_;
+        std::vector<NetworkEvent> batch;
+        uint64_t last = lastEventId_;
+        bool resync = !resume_;
+
+        os << "retry: 3000\n\n";
+        for (;;) {
+            batch.clear();
+            if (resync || !context_.events.since(last, batch)) {
+                batch.clear();
+                last = context_.events.lastId();
+                writeSnapshot(os, last);
+                context_.events.since(last, batch);
+                resync = false;
+            }
+            for (std::vector<NetworkEvent>::const_iterator itr = batch.begin(); itr != batch.end(); ++itr) {
+                writeEvent(os, itr->id, itr->type, itr->data);
+                last = itr->id;
+            }
+            os.flush();
+
+            // Stop on client disconnect (flush fails), shutdown or after
+            // maxDuration; EventSource reconnects with Last-Event-ID.
+            if (!os || context_.events.closed() || std::chrono::steady_clock::now() >= deadline)
+                break;
+            if (!context_.events.wait(last, std::chrono::seconds(15)) && !context_.events.closed())
+                os << ": keep-alive\n\n";
+        }
+    }
+
+private:
+    void writeSnapshot(std::ostream & os, uint64_t id) {
+        NetworkState::snapshot_pointer snapshot = context_.state.snapshot();
+        if (snapshot)
+            writeEvent(os, id, "snapshot", snapshot->body());
+    }
+
+    static void writeEvent(std::ostream & os, uint64_t id, const std::string & type, const std::string & data) {
+        os << "id: " << id << '\n' << "event: " << type << '\n';
+        // Every line of a multi-line payload needs its own data field.
+        std::string::size_type begin = 0;
+        for (;;) {
+            std::string::size_type end = data.find('\n', begin);
+            os << "data: ";
+            os.write(data.data() + begin, (end == std::string::npos ? data.size() : end) - begin);
+            os << '\n';
+            if (end == std::string::npos)
+                break;
+            begin = end + 1;
+        }
+        os << '\n';
+    }
+
+    AppContext & context_;
+    int maxStreams_;
+    std::chrono::seconds maxDuration_;
+    uint64_t lastEventId_;
+    bool resume_;
+    bool counted_;
+};
+#endif //MYEVENTS_H
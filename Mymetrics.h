@@ -0,0 +1,42 @@
+#ifndef MYMETRICS_H
+#define MYMETRICS_H
+
+#include <string>
+
+#include <restcgi/resource.h>
+#include <restcgi/method.h>
+#include <restcgi/hdr.h>
+
+#include "Metrics.h"
+
+using namespace restcgi;
+
+// GET /metrics: this process's Metrics in the Prometheus text format,
+// labelled with its worker when other processes serve the same socket.
+class Mymetrics : public restcgi::resource {
+public:
+	Mymetrics(Metrics & metrics = Metrics::instance()):
+	restcgi::resource (method_e::GET | method_e::HEAD), metrics_(metrics) {
+
+	}
+
+    version read(bool veronly) {
+		body_ = metrics_.render();
+    	return version();
+    }
+
+    void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
+        rh.cache_control("no-store");
+        ch.content_type("text/plain; version=0.0.4");
+        ch.content_length(body_.length());
+    }
+
+    void write(ocontent::pointer oc) {
+        *oc << body_;
+    }
+
+private:
+	Metrics & metrics_;
+	std::string body_;
+};
+#endif //MYMETRICS_H
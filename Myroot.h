@@ -3,15 +3,28 @@
 
 #include <restcgi/resource.h>
 #include <restcgi/version.h>
+#include <restcgi/hdr.h>
+#include <restcgi/exception.h>
+#include <restcgi/method.h>
 
 #include "NetworkData.h"
+#include "NetworkState.h"
+#include "FieldProjection.h"
+#include "AppContext.h"
+#include "Myevents.h"
+#include "Mybatch.h"
+#include "Mydevices.h"
+#include "Myconnections.h"
+#include "Myconnectivity.h"
+#include "Mymetrics.h"
+#include "Mytrace.h"
 
 using namespace restcgi;
 
 class Myroot : public restcgi::resource {
 public:
-	Myroot(int methods_allowed_mask):
-	restcgi::resource (methods_allowed_mask) {
+	Myroot(int methods_allowed_mask, AppContext & context):
+	restcgi::resource (methods_allowed_mask), context_(context) {
 
 	}
 
@@ -20,44 +33,165 @@ public:
 	/*void get_method() {
 	}*/
 
+	// Representations offered to Accept, in order of preference.
+	static const char * const * mediaTypes() {
+		static const char * const types[] = { "application/json", "application/x-cereal-portable-binary", 0 };
+		return types;
+	}
+
+	// The snapshot carries a content-hash ETag and its publication time, so
+	// If-None-Match / If-Modified-Since resolve to 304 in get_method() before
+	// anything is written. With ?fields=, ?since= or a binary representation
+	// the tag is derived from the snapshot hash, the field list, the base
+	// generation and the media type, so it still needs no rendering.
+	//
+	// ?since=<generation id> answers with a JSON Patch from that generation
+	// while the state history still holds it, and with the full document
+	// otherwise; X-Generation tells the client what to ask for next time.
+	// The id carries the epoch of the process that numbered the generation,
+	// so one from another process or from before a restart, or a bare
+	// number, gets the full document too.
+	//
+	// The state is refreshed in the background; a request only nudges the
+	// refresher and never waits on NetworkManager.
     version read(bool veronly) {
-		cout<<"read\n";
-    	return version();
+		mediaType_ = method()->request_hdr().accept_select(mediaTypes());
+		if (mediaType_.empty())
+			throw not_acceptable();
+		binary_ = mediaType_ != mediaTypes()[0];
+
+		// Pinned, not copied: the snapshots stay valid until this resource
+		// is destroyed at the end of the request.
+		if (context_.refresher)
+			context_.refresher->touch();
+		reader_.open(context_.state);
+		snapshot_ = reader_.snapshot();
+		if (!snapshot_)
+			throw service_unavailable("network state not available yet", 1);
+
+		uripp::query::const_iterator itr = method()->uri_query().find("fields");
+		if (itr != method()->uri_query().end())
+			fields_ = FieldSet::parse(itr->second);
+		itr = method()->uri_query().find("since");
+		if (itr != method()->uri_query().end() && !binary_)
+			base_ = since(itr->second);
+		if (prerendered())
+	    	return version(version_tag(snapshot_->etag()), date_time(snapshot_->modified()));
+		uint64_t hash = snapshot_->hash();
+		std::string key = fields_.key();
+		if (base_)
+			key += ";since=" + base_->generationId();
+		hash = fnv1a64(key.data(), key.size(), hash);
+		hash = fnv1a64(mediaType_.data(), mediaType_.size(), hash);
+    	return version(version_tag(strongETag(hash)), date_time(snapshot_->modified()));
+    }
+
+    // The full JSON representation is pre-rendered in the snapshot; only a
+    // projection, a patch or the binary form has to be serialized. A
+    // projection is written from the thread's encode() buffer, which
+    // nothing else on this thread touches before write().
+    void render() {
+    	Metrics::instance().cache(Metrics::RENDER_CACHE, prerendered());
+    	Tracer::Span span("render");
+    	const FieldSet * fields = fields_.empty() ? 0 : &fields_;
+    	if (base_)
+    		rendered_ = snapshot_->data().diff(base_->data(), fields);
+    	else if (binary_)
+    		rendered_ = snapshot_->data().serializePortableBinary(fields);
+    	else if (fields)
+    		projected_ = &snapshot_->data().encode(fields);
     }
 
     void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
-    	cout<<"on_responding\n";
-    
-    	string ip("172.17.0.1");
-        string mask("255.0.0.0");
-        string gateway("192.168.1.1");
-        NetworkData * data = new NetworkData(ip, mask, gateway);
-
-        {
-            cereal::JSONOutputArchive oarchive(stream); // Create an output archive
-            oarchive(*data); // Write the data to the archive
-        }
-
-        ch.content_type("application/json");
-        ch.content_length(stream.str().length() + 1);
+        rh.cache_control("no-cache"); // always revalidate, 304 is cheap
+        rh.vary("Accept");
+        rh.insert("X-Generation", snapshot_->generationId());
+        if (context_.refresher)
+        	markStale(rh, context_.refresher->freshness());
+        else if (context_.follower)
+        	markStale(rh, context_.follower->freshness());
+        ch.content_type(base_ ? "application/json-patch+json" : mediaType_);
+        if (prerendered())
+        	ch.content_length(snapshot_->body().length());
+        else if (me() != method_e::HEAD)
+        	ch.content_length(rendered().length());
     }
 
     void write(ocontent::pointer oc) {
-        cout<<"write\n";
+        *oc << (prerendered() ? snapshot_->body() : rendered());
+    }
+
+    pointer locate(uri_path_type& path) {
+    	if (path.front() == "events") {
+    		path.pop_front();
+    		return pointer(new Myevents(context_, context_.maxEventStreams));
+    	}
+    	if (path.front() == "devices") {
+    		path.pop_front();
+    		return pointer(new Mydevices(context_));
+    	}
+    	if (path.front() == "connections") {
+    		if (!context_.connections)
+    			throw not_found("connection control is not enabled");
+    		path.pop_front();
+    		return pointer(new Myconnections(context_));
+    	}
+    	if (path.front() == "connectivity") {
+    		path.pop_front();
+    		return pointer(new Myconnectivity(context_));
+    	}
+    	if (path.front() == "metrics") {
+    		path.pop_front();
+    		return pointer(new Mymetrics());
+    	}
+    	if (path.front() == "trace") {
+    		path.pop_front();
+    		return pointer(new Mytrace(context_.maxEventStreams));
+    	}
+    	if (path.front() == "jobs") {
+    		path.pop_front();
+    		return pointer(new Myjobs(context_));
+    	}
+    	if (path.front() == "batch") {
+    		path.pop_front();
+    		AppContext & context = context_;
+    		int methods = methods_allowed_mask();
+    		return pointer(new Mybatch([&context, methods] { return pointer(new Myroot(methods, context)); }));
+    	}
+	    return pointer(); // unknown segments end up as bad_request
+    }
 
-        *oc << stream.str();
+    // RFC 7234 staleness warnings while NetworkManager is not answering.
+    static void markStale(response_hdr& rh, const NetworkRefresher::Freshness & f) {
+    	if (!f.stale)
+    		return;
+    	rh.warning(f.failed ? "111 - \"Revalidation Failed\"" : "110 - \"Response is Stale\"");
+    	if (f.age >= 0)
+    		rh.age(static_cast<size_t>(f.age));
     }
 
-	//Needs to check the usage of this interface
-    /*pointer locate(uri_path_type& path) {
-    	cout<<"locate\n";
-	    uri_path_ = path;
-	    path.clear();
-	    return pointer();
-    }*/
+    bool prerendered() const { return fields_.empty() && !binary_ && !base_; }
+    const std::string & rendered() const { return projected_ ? *projected_ : rendered_; }
+
+    const NetworkSnapshot * since(const std::string & s) const {
+    	uint64_t epoch, generation;
+    	if (NetworkSnapshot::parseGenerationId(s, epoch, generation))
+    		return reader_.snapshot(epoch, generation);
+    	if (s.empty() || s.size() > 19 || s.find_first_not_of("0123456789") != std::string::npos)
+    		throw bad_request("since: not a generation: " + s);
+    	return 0;
+    }
 
-	std::stringstream stream; // any stream can be used
+    AppContext & context_;
+    NetworkState::Reader reader_;
+    const NetworkSnapshot * snapshot_ = 0;
+    const NetworkSnapshot * base_ = 0; // ?since= generation, if still known and of this epoch
+    std::string mediaType_;
+    bool binary_ = false;
+    FieldSet fields_;
+    std::string rendered_;
+    const std::string * projected_ = 0;
     uri_path_type uri_path_;    
 	
 };
-#endif //MYROOT
\ No newline at end of file
+#endif //MYROOT
@@ -0,0 +1,93 @@
+#ifndef MYTRACE_H
+#define MYTRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include <restcgi/resource.h>
+#include <restcgi/method.h>
+#include <restcgi/hdr.h>
+#include <restcgi/exception.h>
+
+#include "Myevents.h"
+#include "Tracer.h"
+
+using namespace restcgi;
+
+// GET /trace: the phase timings this process still holds, as a Chrome trace
+// (load it in chrome://tracing or ui.perfetto.dev). ?seconds=N, 1 to 30,
+// traces the next N seconds instead, enabling the Tracer meanwhile if
+// FCGIAPP_TRACE has not; the request waits for them. Only one recording
+// runs at a time (409 otherwise), and it holds its worker like an event
+// stream, counted against the same maxStreams.
+class Mytrace : public restcgi::resource {
+public:
+	enum { MAX_SECONDS = 30 };
+
+	Mytrace(int maxStreams, Tracer & tracer = Tracer::instance()):
+	restcgi::resource (method_e::GET | method_e::HEAD), tracer_(tracer), maxStreams_(maxStreams),
+	recording_(false), counted_(false) {
+
+	}
+
+	~Mytrace() {
+		if (counted_)
+			--Myevents::streams();
+		if (recording_)
+			recording() = false;
+	}
+
+    version read(bool veronly) {
+		uripp::query::const_iterator itr = method()->uri_query().find("seconds");
+		if (itr == method()->uri_query().end()) {
+			body_ = tracer_.dump();
+			return version();
+		}
+		int seconds = parseSeconds(itr->second);
+		if (recording().exchange(true))
+			throw conflict("a trace is already being recorded");
+		recording_ = true;
+		if (++Myevents::streams() > maxStreams_) {
+			--Myevents::streams();
+			throw service_unavailable("too many requests holding a worker", 5);
+		}
+		counted_ = true;
+		Tracer::Recording recording(tracer_);
+		std::this_thread::sleep_for(std::chrono::seconds(seconds));
+		body_ = tracer_.dump(recording.started());
+    	return version();
+    }
+
+    void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
+        rh.cache_control("no-store");
+        ch.content_type("application/json");
+        ch.content_length(body_.length());
+    }
+
+    void write(ocontent::pointer oc) {
+        *oc << body_;
+    }
+
+    static int parseSeconds(const std::string & s) {
+    	int seconds = s.size() <= 2 && s.find_first_not_of("0123456789") == std::string::npos ? atoi(s.c_str()) : 0;
+    	if (seconds < 1 || seconds > MAX_SECONDS)
+    		throw bad_request("seconds: not between 1 and " + std::to_string(MAX_SECONDS) + ": " + s);
+    	return seconds;
+    }
+
+private:
+	static std::atomic<bool> & recording() {
+		static std::atomic<bool> busy(false);
+		return busy;
+	}
+
+	Tracer & tracer_;
+	int maxStreams_;
+	bool recording_;
+	bool counted_;
+	std::string body_;
+};
+#endif //MYTRACE_H
@@ -3,47 +3,149 @@
 
 #include <string>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 
 #include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/string.hpp>
+
+#include "FieldProjection.h"
+#include "IpAddress.h"
+#include "JsonEncoder.h"
+#include "JsonPatch.h"
 
 using namespace std;
 
+// Serialized members, in order. Shared by the cereal and JsonEncoder paths
+// so they cannot drift apart.
+#define NETWORK_DATA_FIELDS(FIELD) FIELD(ipAddress) FIELD(netmask) FIELD(gateway)
+
+// A fixed 54-byte record, no heap. The address carries the prefix length
+// of the netmask.
 class NetworkData {
-	string ipAddress;
-	string netmask;
-	string gateway;
+	IpAddress ipAddress;
+	IpAddress netmask;
+	IpAddress gateway;
 
 public:
-	NetworkData(string ipAddress, string netmask, string gateway):
+	NetworkData(IpAddress ipAddress, IpAddress netmask, IpAddress gateway):
 	ipAddress(ipAddress), netmask(netmask), gateway(gateway) {}
 
+	// Text form, e.g. from D-Bus or configuration. Empty strings leave a
+	// member empty; anything unparsable throws std::invalid_argument.
+	NetworkData(const string & ipAddress, const string & netmask, const string & gateway):
+	ipAddress(), netmask(), gateway() {
+		setNetMask(netmask);
+		setIPAddress(ipAddress);
+		setGateWay(gateway);
+	}
+
+	NetworkData(const char * ipAddress, const char * netmask, const char * gateway):
+	NetworkData(string(ipAddress), string(netmask), string(gateway)) {}
+
 	// This method lets cereal know which data members to serialize
 	template<class Archive>
 	void serialize(Archive & archive)
 	{
-    	archive( CEREAL_NVP(ipAddress), CEREAL_NVP(netmask), CEREAL_NVP(gateway) ); // serialize things by passing them to the archive
+    	project( archive NETWORK_DATA_FIELDS(CEREAL_NVP_ARG) ); // serialize things by passing them to the archive (honours ?fields=)
+	}
+
+	// Compact JSON from the compile-time member list. The document has the
+	// same shape as the cereal one ({"value0": {...}}) but no whitespace.
+	string serialize() const
+	{
+		return serialize(0);
+	}
+
+	// Only the members named in fields.
+	string serialize(const FieldSet & fields) const
+	{
+		return serialize(&fields);
+	}
+
+	// As serialize(), but into this thread's buffer, which keeps its
+	// capacity between calls. Valid until the thread's next call.
+	const string & encode(const FieldSet * fields = 0) const
+	{
+		static thread_local string out;
+		out.clear();
+		out.append("{\"value0\":", 10);
+		encodeJson(out, fields);
+		out += '}';
+		return out;
 	}
 
-	string serialize()
+	// cereal PortableBinaryOutputArchive, for clients that negotiate it.
+	// Projected members are simply absent, so the reader must ask for
+	// the same fields.
+	string serializePortableBinary(const FieldSet * fields = 0) const
 	{
-		stringstream stream;
-		{
-			cereal::JSONOutputArchive oarchive(stream); // Create an output archive
-			oarchive(*this); // Write the data to the archive
+		std::ostringstream os;
+		if (fields) {
+			ProjectingArchive<cereal::PortableBinaryOutputArchive> archive(*fields, os);
+			archive(*this);
+		} else {
+			cereal::PortableBinaryOutputArchive archive(os);
+			archive(*this);
 		}
-		return stream.str();
+		return os.str();
 	}
-	
-	void setIPAddress(string ip) {
-		this->ipAddress = ip;
+
+	void encodeJson(string & out, const FieldSet * fields = 0) const
+	{
+		jsonObject(out, fields NETWORK_DATA_FIELDS(JSON_FIELD));
+	}
+
+	// RFC 6902 patch turning the document of from into this one, limited
+	// to fields if given. "[]" when nothing changed.
+	string diff(const NetworkData & from, const FieldSet * fields = 0) const
+	{
+		string out("[");
+#define NETWORK_DATA_DIFF(m) \
+		if (m != from.m && (!fields || fields->contains(#m))) \
+			appendJsonPatchReplace(out, "/value0/" #m, m);
+		NETWORK_DATA_FIELDS(NETWORK_DATA_DIFF)
+#undef NETWORK_DATA_DIFF
+		out += ']';
+		return out;
+	}
+
+	const IpAddress & getIPAddress() const { return ipAddress; }
+	const IpAddress & getNetMask() const { return netmask; }
+	const IpAddress & getGateWay() const { return gateway; }
+
+	void setIPAddress(const string & ip) {
+		ipAddress = parse(ip, "ipAddress");
+		if (!ipAddress.empty() && netmask.family == ipAddress.family)
+			ipAddress.prefix = static_cast<uint8_t>(netmask.maskLength());
+	}
+
+	void setNetMask(const string & netmask) {
+		IpAddress mask = parse(netmask, "netmask");
+		if (!mask.empty() && mask.maskLength() < 0)
+			throw std::invalid_argument("netmask: not a contiguous mask: " + netmask);
+		this->netmask = mask;
+		if (!ipAddress.empty() && mask.family == ipAddress.family)
+			ipAddress.prefix = static_cast<uint8_t>(mask.maskLength());
 	}
 
-	void setNetMask(string netmask) {
-		this->netmask = netmask;
+	void setGateWay(const string & gateway) {
+		this->gateway = parse(gateway, "gateway");
 	}
 
-	void setGateWay(string gateway) {
-		this->gateway = gateway;
+private:
+	string serialize(const FieldSet * fields) const
+	{
+		return encode(fields);
+	}
+
+	static IpAddress parse(const string & text, const char * member)
+	{
+		IpAddress address;
+		if (!IpAddress::parse(text, address))
+			throw std::invalid_argument(string(member) + ": not an IP address: " + text);
+		return address;
 	}
 };
 #endif // NETWORK_DATA_H
\ No newline at end of file
@@ -0,0 +1,135 @@
+/*
+ *	This file was automatically generated by xml2mirror; DO NOT EDIT!
+ */
+
+#ifndef __xml2mirror__NetworkManagerMirror_h
+#define __xml2mirror__NetworkManagerMirror_h
+
+#include <dbus-c++/dbus.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace org {
+namespace freedesktop {
+
+struct NetworkManager_mirror
+{
+    static const char *interface_name() { return "org.freedesktop.NetworkManager"; }
+
+    /* properties exported by this interface */
+    uint32_t Connectivity;
+    uint32_t State;
+    std::string Version;
+    ::DBus::Path ActivatingConnection;
+    ::DBus::Path PrimaryConnection;
+    std::vector< ::DBus::Path > ActiveConnections;
+    bool WimaxHardwareEnabled;
+    bool WimaxEnabled;
+    bool WwanHardwareEnabled;
+    bool WwanEnabled;
+    bool WirelessHardwareEnabled;
+    bool WirelessEnabled;
+    bool NetworkingEnabled;
+
+    NetworkManager_mirror()
+    : Connectivity()
+    , State()
+    , Version()
+    , ActivatingConnection()
+    , PrimaryConnection()
+    , ActiveConnections()
+    , WimaxHardwareEnabled()
+    , WimaxEnabled()
+    , WwanHardwareEnabled()
+    , WwanEnabled()
+    , WirelessHardwareEnabled()
+    , WirelessEnabled()
+    , NetworkingEnabled()
+    {
+    }
+
+    /* Decodes one property value from vi into its member; false for names
+     * this interface does not have. */
+    bool apply(const std::string &name, ::DBus::MessageIter &vi)
+    {
+        if (name == "Connectivity")
+            vi >> Connectivity;
+        else if (name == "State")
+            vi >> State;
+        else if (name == "Version")
+            vi >> Version;
+        else if (name == "ActivatingConnection")
+            vi >> ActivatingConnection;
+        else if (name == "PrimaryConnection")
+            vi >> PrimaryConnection;
+        else if (name == "ActiveConnections")
+            vi >> ActiveConnections;
+        else if (name == "WimaxHardwareEnabled")
+            vi >> WimaxHardwareEnabled;
+        else if (name == "WimaxEnabled")
+            vi >> WimaxEnabled;
+        else if (name == "WwanHardwareEnabled")
+            vi >> WwanHardwareEnabled;
+        else if (name == "WwanEnabled")
+            vi >> WwanEnabled;
+        else if (name == "WirelessHardwareEnabled")
+            vi >> WirelessHardwareEnabled;
+        else if (name == "WirelessEnabled")
+            vi >> WirelessEnabled;
+        else if (name == "NetworkingEnabled")
+            vi >> NetworkingEnabled;
+        else
+            return false;
+        return true;
+    }
+
+    bool apply(const std::string &name, const ::DBus::Variant &value)
+    {
+        ::DBus::MessageIter vi = value.reader();
+        return apply(name, vi);
+    }
+
+    /* PropertiesChanged delta; returns the number of members updated. */
+    size_t apply(const std::map< std::string, ::DBus::Variant > &props)
+    {
+        size_t applied = 0;
+        for (std::map< std::string, ::DBus::Variant >::const_iterator it = props.begin(); it != props.end(); ++it)
+            applied += apply(it->first, it->second);
+        return applied;
+    }
+
+    /* org.freedesktop.DBus.Properties.GetAll reply (a{sv}), decoded straight
+     * from the message into the members. */
+    size_t decode_GetAll(const ::DBus::Message &reply)
+    {
+        ::DBus::MessageIter ri = reply.reader();
+        ::DBus::MessageIter dict = ri.recurse();
+        size_t applied = 0;
+        for (; !dict.at_end(); ++dict) {
+            ::DBus::MessageIter entry = dict.recurse();
+            std::string name;
+            entry >> name;
+            ::DBus::MessageIter vi = entry.recurse();
+            applied += apply(name, vi);
+        }
+        return applied;
+    }
+
+    /* One GetAll round trip through proxy, an object proxy for this interface. */
+    size_t GetAll(::DBus::InterfaceProxy &proxy)
+    {
+        ::DBus::CallMessage call;
+        call.member("GetAll"); call.interface("org.freedesktop.DBus.Properties");
+        ::DBus::MessageIter wi = call.writer();
+        const std::string interface = interface_name();
+        wi << interface;
+        ::DBus::Message ret = proxy.invoke_method(call);
+        return decode_GetAll(ret);
+    }
+};
+
+} // namespace freedesktop
+} // namespace org
+
+#endif //__xml2mirror__NetworkManagerMirror_h
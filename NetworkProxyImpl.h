@@ -1,24 +1,120 @@
-
 #ifndef NETWORKPROXY_IMPL_H
 #define NETWORKPROXY_IMPL_H
 
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
 #include "NetworkProxy.h"
+#include "NetworkManagerMirror.h"
+#include "EventRing.h"
+#include "Metrics.h"
+#include "PathDecoder.h"
 
 class NetworkManager_proxyImpl : public org::freedesktop::NetworkManager_proxy,
 				public DBus::IntrospectableProxy,
 				public DBus::ObjectProxy
 {
 public:
-	NetworkManager_proxyImpl(DBus::Connection &connection, const char *path, const char *name):
-	DBus::ObjectProxy(connection, path, name)
+	NetworkManager_proxyImpl(DBus::Connection &connection, const char *path, const char *name, EventRing *events = 0):
+	DBus::ObjectProxy(connection, path, name), events_(events)
 	{
 	}
 
-	void DeviceRemoved(const ::DBus::Path& argin0) {}
-    void DeviceAdded(const ::DBus::Path& argin0) {}
-    void PropertiesChanged(const std::map< std::string, ::DBus::Variant >& argin0) {}
-    void StateChanged(const uint32_t& argin0) {}
+	// Signal handlers run on the dispatcher thread. They only update the
+	// mirror, publish events and call changed; they must never make a
+	// blocking call on this proxy, as its reply would wait on this thread.
+	void DeviceRemoved(const ::DBus::Path& argin0) {
+		changed();
+		publish("DeviceRemoved", cereal::make_nvp("device", std::string(argin0)));
+	}
+
+    void DeviceAdded(const ::DBus::Path& argin0) {
+		changed();
+		publish("DeviceAdded", cereal::make_nvp("device", std::string(argin0)));
+    }
+
+    void PropertiesChanged(const std::map< std::string, ::DBus::Variant >& argin0) {
+		{
+			std::lock_guard<std::mutex> lock(mirrorMutex_);
+			mirror_.apply(argin0);
+		}
+		changed();
+		std::vector<std::string> properties;
+		for (std::map< std::string, ::DBus::Variant >::const_iterator itr = argin0.begin(); itr != argin0.end(); ++itr)
+			properties.push_back(itr->first);
+		publish("PropertiesChanged", cereal::make_nvp("properties", properties));
+    }
+
+    void StateChanged(const uint32_t& argin0) {
+		changed();
+		publish("StateChanged", cereal::make_nvp("state", argin0));
+    }
+
     void CheckPermissions() {}
 
+	// Reloads every property in one GetAll; PropertiesChanged keeps the
+	// mirror current after that. Only the refresher thread calls this.
+	void refresh() {
+		org::freedesktop::NetworkManager_mirror fresh;
+		{
+			Metrics::DBusTimer timer(Metrics::NM_GET_ALL);
+			fresh.GetAll(static_cast<org::freedesktop::NetworkManager_proxy &>(*this));
+		}
+		std::lock_guard<std::mutex> lock(mirrorMutex_);
+		mirror_ = fresh;
+	}
+
+	// GetDevices, with the paths interned straight out of the reply,
+	// without a ::DBus::Path per device. Refresher thread only.
+	std::vector<PathId> devices() {
+		::DBus::CallMessage call;
+		call.member("GetDevices");
+		Metrics::DBusTimer timer(Metrics::GET_DEVICES);
+		return decodePaths(static_cast<org::freedesktop::NetworkManager_proxy &>(*this).invoke_method(call));
+	}
+
+	// Called on every NetworkManager signal. Set before the dispatcher
+	// thread starts.
+	void onChange(std::function<void()> changed) {
+		changed_ = changed;
+	}
+
+	// Property values without a D-Bus round trip.
+	org::freedesktop::NetworkManager_mirror mirror() const {
+		std::lock_guard<std::mutex> lock(mirrorMutex_);
+		return mirror_;
+	}
+
+private:
+	void changed() {
+		if (changed_)
+			changed_();
+	}
+
+	template<class T>
+	void publish(const char * type, const cereal::NameValuePair<T> & nvp) {
+		if (!events_)
+			return;
+		std::stringstream stream;
+		{
+			cereal::JSONOutputArchive oarchive(stream, cereal::JSONOutputArchive::Options::NoIndent());
+			oarchive(nvp);
+		}
+		events_->publish(type, stream.str());
+	}
+
+	static constexpr const char * INTERFACE = "org.freedesktop.NetworkManager";
+
+	EventRing *events_;
+	std::function<void()> changed_;
+	mutable std::mutex mirrorMutex_;
+	org::freedesktop::NetworkManager_mirror mirror_;
 };
-#endif //NETWORKPROXY_IMPL_H
\ No newline at end of file
+#endif //NETWORKPROXY_IMPL_H
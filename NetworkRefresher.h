@@ -0,0 +1,145 @@
+#ifndef NETWORK_REFRESHER_H
+#define NETWORK_REFRESHER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "CircuitBreaker.h"
+#include "NetworkState.h"
+
+// Keeps NetworkState fed from NetworkManager off the request path. fetch
+// does the (deadline-bounded) D-Bus calls and throws on failure; it runs
+// on a background thread behind a CircuitBreaker, so a slow or restarting
+// NetworkManager never holds up a request. Requests call touch(), which
+// wakes the thread when the state is older than the refresh interval, and
+// serve whatever snapshot is current, flagging it with freshness(). D-Bus
+// signals call invalidate() to refresh straight away. Left idle, the
+// thread refreshes every maxAge / 2 by itself, so a healthy NetworkManager
+// never shows as stale to the first request after a quiet spell.
+class NetworkRefresher {
+public:
+	typedef CircuitBreaker::clock clock;
+	typedef std::function<NetworkData()> fetch_type;
+
+	struct Freshness {
+		bool stale;    // not confirmed within maxAge
+		bool failed;   // the last attempt failed, or the breaker is open
+		long age;      // seconds since last confirmed; -1 if never
+	};
+
+	NetworkRefresher(NetworkState & state, fetch_type fetch, CircuitBreaker & breaker,
+	                 clock::duration interval = std::chrono::seconds(1),
+	                 clock::duration maxAge = std::chrono::seconds(10)):
+	state_(state), fetch_(fetch), breaker_(breaker), interval_(interval), maxAge_(maxAge),
+	lastGood_(NEVER), lastAttempt_(NEVER), failed_(false), pending_(false), stopping_(false) {}
+
+	~NetworkRefresher() { stop(); }
+
+	// One attempt on the calling thread, through the breaker.
+	bool refresh(clock::time_point now = clock::now()) {
+		lastAttempt_.store(ticks(now));
+		if (!breaker_.allow(now)) {
+			failed_ = true;
+			return false;
+		}
+		try {
+			NetworkData data = fetch_();
+			state_.update(data);
+		} catch (const std::exception &) {
+			breaker_.failure(now);
+			failed_ = true;
+			return false;
+		}
+		breaker_.success();
+		lastGood_.store(ticks(now));
+		failed_ = false;
+		return true;
+	}
+
+	void start() {
+		worker_ = std::thread(&NetworkRefresher::run, this);
+	}
+
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		wake_.notify_one();
+		if (worker_.joinable())
+			worker_.join();
+	}
+
+	// Request path: lock-free unless a refresh is due.
+	void touch(clock::time_point now = clock::now()) {
+		if (ticks(now) - lastAttempt_.load() < interval_.count() || pending_.exchange(true))
+			return;
+		std::lock_guard<std::mutex> lock(mutex_);
+		wake_.notify_one();
+	}
+
+	// Something changed upstream (a NetworkManager signal): refresh now,
+	// regardless of the interval. Safe from any thread, never blocks on
+	// D-Bus, so it may be called from the dispatcher thread.
+	void invalidate() {
+		if (pending_.exchange(true))
+			return;
+		std::lock_guard<std::mutex> lock(mutex_);
+		wake_.notify_one();
+	}
+
+	Freshness freshness(clock::time_point now = clock::now()) const {
+		Freshness f;
+		clock::rep good = lastGood_.load();
+		f.failed = failed_.load() || breaker_.state() == CircuitBreaker::OPEN;
+		f.stale = good == NEVER || ticks(now) - good > maxAge_.count() || f.failed;
+		f.age = good == NEVER ? -1 : static_cast<long>(std::chrono::duration_cast<std::chrono::seconds>(clock::duration(ticks(now) - good)).count());
+		return f;
+	}
+
+private:
+	static const clock::rep NEVER = -1;
+
+	static clock::rep ticks(clock::time_point t) { return t.time_since_epoch().count(); }
+
+	void run() {
+		const clock::duration idle = maxAge_ / 2;
+		const clock::duration tick = std::min<clock::duration>(std::chrono::seconds(1), idle);
+		std::unique_lock<std::mutex> lock(mutex_);
+		for (;;) {
+			if (!wake_.wait_for(lock, tick, [this] { return stopping_ || pending_.load(); })
+			    && ticks(clock::now()) - lastAttempt_.load() < idle.count())
+				continue;
+			if (stopping_)
+				return;
+			// Cleared before fetching, so that an invalidate() arriving
+			// while the fetch may already have read the old data is kept
+			// for another round.
+			pending_ = false;
+			lock.unlock();
+			refresh();
+			lock.lock();
+		}
+	}
+
+	NetworkState & state_;
+	fetch_type fetch_;
+	CircuitBreaker & breaker_;
+	const clock::duration interval_;
+	const clock::duration maxAge_;
+	std::atomic<clock::rep> lastGood_;
+	std::atomic<clock::rep> lastAttempt_;
+	std::atomic<bool> failed_;
+	std::atomic<bool> pending_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	bool stopping_;
+	std::thread worker_;
+};
+#endif // NETWORK_REFRESHER_H
@@ -0,0 +1,191 @@
+#ifndef NETWORK_STATE_H
+#define NETWORK_STATE_H
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <stdint.h>
+
+#include "ETag.h"
+#include "NetworkData.h"
+#include "Rcu.h"
+
+// Immutable view of the network state at one generation. The JSON body and
+// its entity tag are produced once, when the snapshot is published, so that
+// requests only ever copy bytes out of it.
+//
+// Generations count from 1 in every NetworkState, so they are qualified by
+// the epoch of the state that numbered them; a generation id names one
+// snapshot across processes and restarts.
+class NetworkSnapshot {
+	NetworkData data_;
+	uint64_t epoch_;
+	uint64_t generation_;
+	time_t modified_;
+	string body_;
+	uint64_t hash_;
+	string etag_;
+
+public:
+	NetworkSnapshot(const NetworkData & data, uint64_t epoch, uint64_t generation, time_t modified, const string & body):
+	data_(data), epoch_(epoch), generation_(generation), modified_(modified), body_(body), hash_(fnv1a64(body)), etag_(strongETag(hash_)) {}
+
+	const NetworkData & data() const { return data_; }
+	uint64_t epoch() const { return epoch_; }
+	uint64_t generation() const { return generation_; }
+
+	// "<epoch>.<generation>", as sent in X-Generation and taken by ?since=.
+	string generationId() const {
+		char text[40];
+		snprintf(text, sizeof(text), "%016llx.%llu", static_cast<unsigned long long>(epoch_), static_cast<unsigned long long>(generation_));
+		return text;
+	}
+
+	// The inverse of generationId(); false if text is not one.
+	static bool parseGenerationId(const string & text, uint64_t & epoch, uint64_t & generation) {
+		string::size_type dot = text.find('.');
+		if (dot != 16 || text.find_first_not_of("0123456789abcdef") != dot
+		    || text.size() == dot + 1 || text.size() > dot + 20 || text.find_first_not_of("0123456789", dot + 1) != string::npos)
+			return false;
+		epoch = strtoull(text.substr(0, dot).c_str(), 0, 16);
+		generation = strtoull(text.c_str() + dot + 1, 0, 10);
+		return true;
+	}
+
+	time_t modified() const { return modified_; }
+	const string & body() const { return body_; }
+	uint64_t hash() const { return hash_; }
+	const string & etag() const { return etag_; }
+};
+
+// Holder of the current NetworkSnapshot and of the last few before it, so
+// that clients can ask for the changes since a generation they have seen.
+// update() is called from the D-Bus side; the generation only moves when
+// the serialized representation actually changes, so unchanged polls keep
+// their ETag and Last-Modified.
+//
+// The generations are published through an RcuCell: workers read them
+// through a Reader without taking a lock, only writers serialize. Every
+// snapshot in the history has the same epoch.
+class NetworkState {
+public:
+	typedef std::shared_ptr<const NetworkSnapshot> snapshot_pointer;
+
+private:
+	// Immutable; a new one is published for every generation.
+	struct Generations {
+		std::deque<snapshot_pointer> history; // consecutive, oldest first
+
+		const snapshot_pointer * find(uint64_t generation) const {
+			uint64_t current = history.back()->generation();
+			if (generation == 0 || generation > current || current - generation >= history.size())
+				return 0;
+			return &history[history.size() - 1 - (current - generation)];
+		}
+	};
+
+public:
+	// Lock-free view of the state as published when open() was called.
+	// The snapshots it returns stay valid while it is open.
+	class Reader {
+	public:
+		Reader() {}
+		explicit Reader(const NetworkState & state) { open(state); }
+
+		void open(const NetworkState & state) { generations_.open(state.generations_); }
+
+		const NetworkSnapshot * snapshot() const {
+			return generations_.get() ? generations_->history.back().get() : 0;
+		}
+
+		// The snapshot published as generation, or null once it has left
+		// the history (or was never published).
+		const NetworkSnapshot * snapshot(uint64_t generation) const {
+			const snapshot_pointer * found = generations_.get() ? generations_->find(generation) : 0;
+			return found ? found->get() : 0;
+		}
+
+		// Null as well if the generation was numbered in another epoch.
+		const NetworkSnapshot * snapshot(uint64_t epoch, uint64_t generation) const {
+			const NetworkSnapshot * found = snapshot(generation);
+			return found && found->epoch() == epoch ? found : 0;
+		}
+
+	private:
+		RcuCell<Generations>::Reader generations_;
+	};
+
+	explicit NetworkState(size_t historySize = 32, uint64_t epoch = newEpoch()):
+	epoch_(epoch), generation_(0), historySize_(std::max<size_t>(1, historySize)) {}
+
+	// What update() numbers generations in; adopt() takes on the other's.
+	uint64_t epoch() const {
+		std::lock_guard<std::mutex> lock(writeMutex_);
+		return epoch_;
+	}
+
+	// Owning references, for holders that outlive a request such as event
+	// streams. They cost a reference count where a Reader costs nothing
+	// shared.
+	snapshot_pointer snapshot() const {
+		RcuCell<Generations>::Reader reader(generations_);
+		return reader.get() ? reader->history.back() : snapshot_pointer();
+	}
+
+	snapshot_pointer snapshot(uint64_t generation) const {
+		RcuCell<Generations>::Reader reader(generations_);
+		const snapshot_pointer * found = reader.get() ? reader->find(generation) : 0;
+		return found ? *found : snapshot_pointer();
+	}
+
+	// Returns true if a new generation was published.
+	bool update(const NetworkData & data, time_t now = time(0)) {
+		string body = data.serialize();
+
+		std::lock_guard<std::mutex> lock(writeMutex_);
+		const Generations * current = generations_.current();
+		if (current && current->history.back()->body() == body)
+			return false;
+		Generations * next = new Generations(current ? *current : Generations());
+		next->history.push_back(snapshot_pointer(new NetworkSnapshot(data, epoch_, ++generation_, now, body)));
+		if (next->history.size() > historySize_)
+			next->history.pop_front();
+		generations_.publish(next);
+		return true;
+	}
+
+	// Publishes data as the given generation of another process's state
+	// (see SharedSnapshot), so that X-Generation and ?since= agree across
+	// processes. The history is kept only while generations of one epoch
+	// follow on.
+	bool adopt(const NetworkData & data, uint64_t epoch, uint64_t generation, time_t modified) {
+		string body = data.serialize();
+
+		std::lock_guard<std::mutex> lock(writeMutex_);
+		const Generations * current = generations_.current();
+		if (current && epoch == epoch_ && generation == generation_)
+			return false;
+		bool follows = current && epoch == epoch_ && generation == generation_ + 1;
+		Generations * next = follows ? new Generations(*current) : new Generations();
+		next->history.push_back(snapshot_pointer(new NetworkSnapshot(data, epoch, generation, modified, body)));
+		if (next->history.size() > historySize_)
+			next->history.pop_front();
+		epoch_ = epoch;
+		generation_ = generation;
+		generations_.publish(next);
+		return true;
+	}
+
+private:
+	mutable std::mutex writeMutex_;
+	uint64_t epoch_;
+	uint64_t generation_;
+	size_t historySize_;
+	RcuCell<Generations> generations_;
+};
+#endif // NETWORK_STATE_H
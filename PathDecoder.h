@@ -0,0 +1,35 @@
+#ifndef PATH_DECODER_H
+#define PATH_DECODER_H
+
+#include <cstring>
+#include <vector>
+
+#include <dbus-c++/dbus.h>
+
+#include "PathTable.h"
+
+// Walks an array of object paths ("ao") in place: f gets each path as the
+// pointer libdbus hands out into the message, valid while the message is,
+// without building a ::DBus::Path per element. Returns the element count.
+template<class F>
+size_t forEachPath(::DBus::MessageIter array, F f)
+{
+	size_t n = 0;
+	for (::DBus::MessageIter ai = array.recurse(); !ai.at_end(); ++ai, ++n) {
+		const char * path = ai.get_path();
+		f(path, strlen(path));
+	}
+	return n;
+}
+
+// The first argument of reply, an "ao", as interned ids.
+inline std::vector<PathId> decodePaths(const ::DBus::Message & reply, PathTable & table = PathTable::instance())
+{
+	std::vector<PathId> ids;
+	PathTable::Batch intern(table);
+	forEachPath(reply.reader(), [&](const char * path, size_t length) {
+		ids.push_back(intern(path, length));
+	});
+	return ids;
+}
+#endif // PATH_DECODER_H
@@ -0,0 +1,176 @@
+#ifndef PATH_TABLE_H
+#define PATH_TABLE_H
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Interned D-Bus object path: equal paths have equal ids.
+typedef uint32_t PathId;
+
+// Symbol table for object paths. A path seen before is found by hashing
+// its bytes where they lie (e.g. inside a D-Bus reply) and comparing them
+// with the stored copy, so looking it up allocates nothing; only the
+// first sighting of a path copies it. name() takes no lock, so ids can be
+// resolved while other threads intern new paths.
+//
+// NetworkManager never reuses an object path, so sweep() has to retire
+// the ones that are gone: an id not interned since the sweep before last
+// is freed, and its string is overwritten in place when the id is handed
+// out again. name() of an id that may have been swept therefore belongs on
+// the thread that sweeps, the refresher; nothing else may hold an id
+// across a sweep.
+class PathTable {
+public:
+	enum { CHUNK = 1024, MAX_CHUNKS = 1024 }; // up to a million live paths
+
+	static PathTable & instance() {
+		static PathTable table;
+		return table;
+	}
+
+	PathTable(): size_(0), slots_(1024, EMPTY), live_(0), generation_(1) {
+		for (size_t i = 0; i < MAX_CHUNKS; ++i)
+			chunks_[i].store(0, std::memory_order_relaxed);
+	}
+
+	~PathTable() {
+		for (size_t i = 0; i < MAX_CHUNKS; ++i)
+			delete[] chunks_[i].load();
+	}
+
+	PathTable(const PathTable &) = delete;
+	PathTable & operator=(const PathTable &) = delete;
+
+	// Interns many paths under one lock, e.g. all of a reply's.
+	class Batch {
+	public:
+		explicit Batch(PathTable & table): table_(table), lock_(table.mutex_) {}
+		PathId operator()(const char * path, size_t length) { return table_.internLocked(path, length); }
+	private:
+		PathTable & table_;
+		std::lock_guard<std::mutex> lock_;
+	};
+
+	PathId intern(const char * path, size_t length) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return internLocked(path, length);
+	}
+
+	PathId intern(const char * path) { return intern(path, strlen(path)); }
+	PathId intern(const std::string & path) { return intern(path.data(), path.size()); }
+
+	// Frees the ids not interned since the sweep before last; run it after
+	// each GetDevices reply. An id stays valid for as long as its path is
+	// interned again between any two sweeps, as every reply does.
+	void sweep() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		PathId size = size_.load(std::memory_order_relaxed);
+		for (PathId id = 0; id < size; ++id) {
+			if (seen_[id] != FREE && seen_[id] + 1 < generation_) {
+				seen_[id] = FREE;
+				free_.push_back(id);
+				--live_;
+			}
+		}
+		++generation_;
+		rebuild(slots_.size());
+	}
+
+	// The path of an id returned by intern() and not swept since. Not
+	// safe against a concurrent intern() that reuses the id; see above.
+	const std::string & name(PathId id) const {
+		if (id >= size_.load(std::memory_order_acquire))
+			throw std::out_of_range("PathTable: unknown path id");
+		return at(id);
+	}
+
+	// Ids handed out so far, freed ones included.
+	size_t size() const { return size_.load(std::memory_order_acquire); }
+
+private:
+	enum { EMPTY = 0xffffffffu, FREE = 0xffffffffu };
+
+	PathId internLocked(const char * path, size_t length) {
+		uint64_t hash = hashPath(path, length);
+		size_t mask = slots_.size() - 1;
+		size_t i = hash & mask;
+		for (; slots_[i] != EMPTY; i = (i + 1) & mask) {
+			const std::string & known = at(slots_[i]);
+			if (known.size() == length && memcmp(known.data(), path, length) == 0) {
+				seen_[slots_[i]] = generation_;
+				return slots_[i];
+			}
+		}
+		PathId id;
+		if (!free_.empty()) {
+			id = free_.back();
+			free_.pop_back();
+			chunks_[id / CHUNK].load(std::memory_order_relaxed)[id % CHUNK].assign(path, length);
+			seen_[id] = generation_;
+		} else {
+			id = size_.load(std::memory_order_relaxed);
+			if (id >= CHUNK * MAX_CHUNKS)
+				throw std::length_error("PathTable: too many object paths");
+			if (id % CHUNK == 0)
+				chunks_[id / CHUNK].store(new std::string[CHUNK], std::memory_order_release);
+			chunks_[id / CHUNK].load(std::memory_order_relaxed)[id % CHUNK].assign(path, length);
+			seen_.push_back(generation_);
+			size_.store(id + 1, std::memory_order_release);
+		}
+		slots_[i] = id;
+		if (2 * ++live_ > slots_.size())
+			rebuild(slots_.size() * 2);
+		return id;
+	}
+
+	// Eight bytes a step; object paths are long and share their prefix.
+	static uint64_t hashPath(const char * p, size_t n) {
+		uint64_t h = n * 0x9e3779b97f4a7c15ULL, w;
+		for (; n >= 8; p += 8, n -= 8) {
+			memcpy(&w, p, 8);
+			h = (h ^ w) * 0xbf58476d1ce4e5b9ULL;
+			h ^= h >> 31;
+		}
+		w = 0;
+		memcpy(&w, p, n);
+		h = (h ^ w) * 0x94d049bb133111ebULL;
+		return h ^ h >> 29;
+	}
+
+	const std::string & at(PathId id) const {
+		return chunks_[id / CHUNK].load(std::memory_order_acquire)[id % CHUNK];
+	}
+
+	// Re-indexes the live ids, e.g. into twice the slots; the strings
+	// themselves never move.
+	void rebuild(size_t capacity) {
+		std::vector<PathId> slots(capacity, EMPTY);
+		size_t mask = slots.size() - 1;
+		for (size_t s = 0; s < slots_.size(); ++s) {
+			if (slots_[s] == EMPTY || seen_[slots_[s]] == FREE)
+				continue;
+			const std::string & path = at(slots_[s]);
+			size_t i = hashPath(path.data(), path.size()) & mask;
+			while (slots[i] != EMPTY)
+				i = (i + 1) & mask;
+			slots[i] = slots_[s];
+		}
+		slots_.swap(slots);
+	}
+
+	std::mutex mutex_;               // intern(), sweep() and the index
+	std::atomic<PathId> size_;
+	std::vector<PathId> slots_;      // open addressing, power of two
+	std::atomic<std::string *> chunks_[MAX_CHUNKS];
+	std::vector<uint32_t> seen_;     // by id: generation last interned, or FREE
+	std::vector<PathId> free_;
+	size_t live_;
+	uint32_t generation_;
+};
+#endif // PATH_TABLE_H
@@ -0,0 +1,190 @@
+#ifndef PREFORK_H
+#define PREFORK_H
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Keeps count worker processes running from one master. Each worker is a
+// fresh exec of path with the listen socket as its stdin, the FastCGI
+// convention, so it needs nothing from the master's address space and the
+// master may fork it from any thread. Worker i is pinned to the i-th CPU
+// the master may run on (round robin), keeping its caches warm.
+//
+// A worker that exits is started again by reap(); one that dies within
+// minUptime of being started waits out the rest of it first, so a worker
+// that cannot start does not spin.
+class Prefork {
+public:
+	typedef std::chrono::steady_clock clock;
+
+	// listenFd < 0 leaves the workers' stdin alone. env is the workers'
+	// whole environment; FCGIAPP_WORKER=<slot> is added to it.
+	Prefork(const std::string & path, const std::vector<std::string> & args, const std::vector<std::string> & env,
+	        int listenFd, int count, bool pin = true, clock::duration minUptime = std::chrono::seconds(1)):
+	path_(path), args_(args), env_(env), listenFd_(listenFd), pin_(pin), minUptime_(minUptime), restarts_(0),
+	slots_(count > 0 ? count : 1) {
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+			for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+				if (CPU_ISSET(cpu, &allowed))
+					cpus_.push_back(cpu);
+	}
+
+	~Prefork() { stop(); }
+
+	Prefork(const Prefork &) = delete;
+	Prefork & operator=(const Prefork &) = delete;
+
+	void start(clock::time_point now = clock::now()) {
+		for (size_t i = 0; i < slots_.size(); ++i)
+			spawn(i, now);
+	}
+
+	// Collects exited workers and starts the ones that are due again,
+	// without blocking. Returns the number started.
+	int reap(clock::time_point now = clock::now()) {
+		int status;
+		pid_t pid;
+		while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+			for (size_t i = 0; i < slots_.size(); ++i) {
+				if (slots_[i].pid != pid)
+					continue;
+				slots_[i].pid = 0;
+				slots_[i].due = std::max(now, slots_[i].started + minUptime_);
+				slots_[i].status = status;
+			}
+		}
+		int started = 0;
+		for (size_t i = 0; i < slots_.size(); ++i) {
+			if (slots_[i].pid == 0 && now >= slots_[i].due) {
+				spawn(i, now);
+				++restarts_;
+				++started;
+			}
+		}
+		return started;
+	}
+
+	// Sends sig to every worker and waits for them, killing the ones still
+	// there after grace.
+	void stop(int sig = SIGTERM, clock::duration grace = std::chrono::seconds(10)) {
+		for (size_t i = 0; i < slots_.size(); ++i)
+			if (slots_[i].pid > 0)
+				kill(slots_[i].pid, sig);
+		clock::time_point deadline = clock::now() + grace;
+		for (size_t i = 0; i < slots_.size(); ++i) {
+			while (slots_[i].pid > 0) {
+				int status;
+				pid_t pid = waitpid(slots_[i].pid, &status, WNOHANG);
+				if (pid == slots_[i].pid || (pid < 0 && errno == ECHILD)) {
+					slots_[i].pid = 0;
+				} else if (clock::now() >= deadline) {
+					kill(slots_[i].pid, SIGKILL);
+					waitpid(slots_[i].pid, &status, 0);
+					slots_[i].pid = 0;
+				} else {
+					std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				}
+			}
+		}
+	}
+
+	// 0 for a slot whose worker is not running.
+	std::vector<pid_t> pids() const {
+		std::vector<pid_t> pids;
+		for (size_t i = 0; i < slots_.size(); ++i)
+			pids.push_back(slots_[i].pid);
+		return pids;
+	}
+
+	size_t restarts() const { return restarts_; }
+
+	// The wait status of the slot's last worker to exit, -1 if none has.
+	int lastStatus(size_t slot) const { return slots_.at(slot).status; }
+
+	// Every worker running, and for at least minUptime.
+	bool settled(clock::time_point now = clock::now()) const {
+		for (size_t i = 0; i < slots_.size(); ++i)
+			if (slots_[i].pid == 0 || now < slots_[i].started + minUptime_)
+				return false;
+		return true;
+	}
+
+	// fork() and execve() path with env. listenFd (unless < 0) is passed
+	// on as stdin, or under its own number if not asStdin; cpu >= 0 pins
+	// the child. Returns the child's pid, -1 if fork() failed.
+	static pid_t launch(const std::string & path, const std::vector<std::string> & args, const std::vector<std::string> & env,
+	                    int listenFd, bool asStdin, int cpu = -1) {
+		// Everything the child needs is prepared before fork(): between
+		// fork() and exec() only async-signal-safe calls are allowed.
+		std::vector<char *> argv, envp;
+		argv.push_back(const_cast<char *>(path.c_str()));
+		for (size_t i = 0; i < args.size(); ++i)
+			argv.push_back(const_cast<char *>(args[i].c_str()));
+		argv.push_back(0);
+		for (size_t i = 0; i < env.size(); ++i)
+			envp.push_back(const_cast<char *>(env[i].c_str()));
+		envp.push_back(0);
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (cpu >= 0)
+			CPU_SET(cpu, &set);
+
+		pid_t pid = fork();
+		if (pid == 0) {
+			if (cpu >= 0)
+				sched_setaffinity(0, sizeof(set), &set);
+			if (listenFd > 0 && asStdin)
+				dup2(listenFd, 0);
+			else if (listenFd >= 0)
+				fcntl(listenFd, F_SETFD, 0);
+			execve(argv[0], &argv[0], &envp[0]);
+			_exit(127);
+		}
+		return pid;
+	}
+
+	// The CPU worker slot is pinned to, -1 without pinning.
+	int cpu(size_t slot) const { return pin_ && !cpus_.empty() ? cpus_[slot % cpus_.size()] : -1; }
+
+private:
+	struct Slot {
+		pid_t pid;
+		clock::time_point started;
+		clock::time_point due;
+		int status;
+		Slot(): pid(0), status(-1) {}
+	};
+
+	void spawn(size_t slot, clock::time_point now) {
+		std::vector<std::string> env(env_);
+		env.push_back("FCGIAPP_WORKER=" + std::to_string(slot));
+		pid_t pid = launch(path_, args_, env, listenFd_, true, cpu(slot));
+		slots_[slot].pid = pid > 0 ? pid : 0;
+		slots_[slot].started = now;
+		slots_[slot].due = now + minUptime_; // fork() failed: try again later
+	}
+
+	std::string path_;
+	std::vector<std::string> args_;
+	std::vector<std::string> env_;
+	int listenFd_;
+	bool pin_;
+	clock::duration minUptime_;
+	size_t restarts_;
+	std::vector<int> cpus_;
+	std::vector<Slot> slots_;
+};
+#endif // PREFORK_H
@@ -0,0 +1,170 @@
+#ifndef RCU_H
+#define RCU_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Epoch-based reclamation. A reader pins the global epoch in its thread's
+// slot for as long as it looks at published objects; a writer that
+// replaces an object retires it at the current epoch and advances the
+// epoch, and the object is freed once no slot is pinned at or before that
+// epoch. Readers never lock and never touch a shared counter, so read
+// throughput scales with the number of threads.
+class EpochDomain {
+public:
+	enum { MAX_THREADS = 128 };
+	static const uint64_t IDLE = UINT64_MAX;
+
+	static EpochDomain & instance() {
+		static EpochDomain domain;
+		return domain;
+	}
+
+	// Nestable; only the outermost enter() pins.
+	void enter() {
+		Thread & t = thread();
+		if (t.depth++ == 0)
+			t.slot->epoch.store(epoch_.load());
+	}
+
+	void exit() {
+		Thread & t = thread();
+		if (--t.depth == 0)
+			t.slot->epoch.store(IDLE, std::memory_order_release);
+	}
+
+	// The epoch objects retired now belong to.
+	uint64_t advance() { return epoch_.fetch_add(1); }
+
+	// Objects retired before this epoch are unreachable.
+	uint64_t oldestPinned() const {
+		uint64_t oldest = IDLE;
+		for (size_t i = 0; i < MAX_THREADS; ++i) {
+			uint64_t e = slots_[i].epoch.load();
+			if (e < oldest)
+				oldest = e;
+		}
+		return oldest;
+	}
+
+private:
+	struct alignas(64) Slot {
+		std::atomic<uint64_t> epoch;
+		std::atomic<bool> owned;
+	};
+
+	// A thread's claim on a slot, released when the thread exits.
+	struct Thread {
+		Slot * slot;
+		unsigned depth;
+		Thread(Slot * slot): slot(slot), depth(0) {}
+		~Thread() { slot->owned.store(false, std::memory_order_release); }
+	};
+
+	EpochDomain(): epoch_(1) {
+		for (size_t i = 0; i < MAX_THREADS; ++i) {
+			slots_[i].epoch.store(IDLE, std::memory_order_relaxed);
+			slots_[i].owned.store(false, std::memory_order_relaxed);
+		}
+	}
+
+	Thread & thread() {
+		static thread_local Thread t(claim());
+		return t;
+	}
+
+	Slot * claim() {
+		for (size_t i = 0; i < MAX_THREADS; ++i) {
+			bool expected = false;
+			if (slots_[i].owned.compare_exchange_strong(expected, true))
+				return &slots_[i];
+		}
+		throw std::runtime_error("EpochDomain: more than MAX_THREADS reader threads");
+	}
+
+	std::atomic<uint64_t> epoch_;
+	Slot slots_[MAX_THREADS];
+};
+
+// A pointer to an immutable T, swapped atomically by publish() and read
+// through a Reader without locking. Writers must be serialized by the
+// caller.
+template<class T>
+class RcuCell {
+public:
+	RcuCell(): current_(0) {}
+
+	~RcuCell() {
+		delete current_.load();
+		for (size_t i = 0; i < retired_.size(); ++i)
+			delete retired_[i].second;
+	}
+
+	RcuCell(const RcuCell &) = delete;
+	RcuCell & operator=(const RcuCell &) = delete;
+
+	// Pins the calling thread's epoch; the T seen through it stays valid
+	// until the Reader is closed or destroyed. Keep it short-lived: a
+	// pinned reader holds back reclamation of everything retired since.
+	class Reader {
+	public:
+		Reader(): value_(0), open_(false) {}
+		explicit Reader(const RcuCell & cell): value_(0), open_(false) { open(cell); }
+		~Reader() { close(); }
+
+		Reader(const Reader &) = delete;
+		Reader & operator=(const Reader &) = delete;
+
+		void open(const RcuCell & cell) {
+			close();
+			EpochDomain::instance().enter();
+			open_ = true;
+			value_ = cell.current_.load();
+		}
+
+		void close() {
+			if (open_)
+				EpochDomain::instance().exit();
+			open_ = false;
+			value_ = 0;
+		}
+
+		const T * get() const { return value_; }
+		const T * operator->() const { return value_; }
+
+	private:
+		const T * value_;
+		bool open_;
+	};
+
+	// Writer side only: the published value, without pinning.
+	const T * current() const { return current_.load(std::memory_order_acquire); }
+
+	// Takes ownership of next; the previous value is freed once no reader
+	// can still see it.
+	void publish(const T * next) {
+		const T * previous = current_.exchange(next);
+		if (!previous)
+			return;
+		EpochDomain & domain = EpochDomain::instance();
+		retired_.push_back(std::make_pair(domain.advance(), previous));
+		uint64_t oldest = domain.oldestPinned();
+		size_t kept = 0;
+		for (size_t i = 0; i < retired_.size(); ++i) {
+			if (retired_[i].first < oldest)
+				delete retired_[i].second;
+			else
+				retired_[kept++] = retired_[i];
+		}
+		retired_.resize(kept);
+	}
+
+private:
+	std::atomic<const T *> current_;
+	std::vector<std::pair<uint64_t, const T *> > retired_; // (epoch, value), writer side
+};
+#endif // RCU_H
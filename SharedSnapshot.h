@@ -0,0 +1,398 @@
+#ifndef SHARED_SNAPSHOT_H
+#define SHARED_SNAPSHOT_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cereal/archives/portable_binary.hpp>
+
+#include "DeviceTable.h"
+#include "EventRing.h"
+#include "NetworkRefresher.h"
+#include "NetworkState.h"
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the segment needs address-free 64-bit atomics");
+
+// The network state of one updater process, in a file mapped MAP_SHARED
+// (e.g. under /dev/shm) by every FastCGI process. The updater writes it
+// under a seqlock: the sequence is odd while a write is in progress, and a
+// reader that sees it change over its copy retries. Readers never write to
+// the segment, never block the updater and never block each other.
+//
+// Everything is copied word by word through relaxed atomics, so a reader
+// racing the updater sees a torn copy it then discards, never undefined
+// behaviour.
+class SharedSnapshot {
+public:
+	enum { CAPACITY = 256 * 1024 }; // bytes of encoded devices
+
+	// Fixed part of the segment.
+	struct Record {
+		uint64_t epoch;             // of the updater's NetworkState
+		uint64_t generation;        // in that epoch, 0 before the first
+		int64_t modified;
+		int64_t confirmed;          // last successful refresh, 0 if none yet
+		uint32_t failed;            // the last refresh failed
+		uint32_t deviceBytes;
+		uint32_t devicesStale;      // the updater's devices outgrew CAPACITY; these are older
+		uint64_t deviceEpoch;       // of the updater's DeviceState
+		uint64_t deviceGeneration;  // in that epoch, 0 before the first
+		int64_t devicesModified;
+		IpAddress ipAddress;
+		IpAddress netmask;
+		IpAddress gateway;
+	};
+
+	// Opens (the updater: creates) the segment at path; throws
+	// std::runtime_error if that fails, or if another updater has it.
+	SharedSnapshot(const std::string & path, bool updater): fd_(-1), segment_(0) {
+		fd_ = open(path.c_str(), updater ? O_RDWR | O_CREAT | O_CLOEXEC : O_RDONLY | O_CLOEXEC, 0644);
+		if (fd_ < 0)
+			fail(path, "open");
+		if (updater && flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+			close(fd_);
+			throw std::runtime_error(path + ": already has an updater");
+		}
+		struct stat st;
+		if (updater && ftruncate(fd_, sizeof(Segment)) != 0)
+			fail(path, "ftruncate");
+		if (fstat(fd_, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Segment)))
+			fail(path, "not a snapshot segment");
+		void * p = mmap(0, sizeof(Segment), updater ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd_, 0);
+		if (p == MAP_FAILED)
+			fail(path, "mmap");
+		segment_ = static_cast<Segment *>(p);
+		if (updater) {
+			// A previous updater may have died half way through a write.
+			if (segment_->sequence.load() & 1)
+				segment_->sequence.fetch_add(1);
+			segment_->layout = LAYOUT;
+			segment_->magic = MAGIC;
+		}
+	}
+
+	~SharedSnapshot() {
+		if (segment_)
+			munmap(segment_, sizeof(Segment));
+		if (fd_ >= 0)
+			close(fd_);
+	}
+
+	SharedSnapshot(const SharedSnapshot &) = delete;
+	SharedSnapshot & operator=(const SharedSnapshot &) = delete;
+
+	// Changes with every write; one load, for polling.
+	uint64_t sequence() const { return segment_->sequence.load(std::memory_order_acquire); }
+
+	// Updater only. devices must fit in CAPACITY.
+	void write(Record record, const std::string & devices) {
+		if (devices.size() > CAPACITY)
+			throw std::length_error("SharedSnapshot: devices exceed the segment");
+		record.deviceBytes = static_cast<uint32_t>(devices.size());
+		uint64_t seq = segment_->sequence.load(std::memory_order_relaxed);
+		segment_->sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		store(segment_->record, &record, sizeof(record));
+		store(segment_->devices, devices.data(), devices.size());
+		segment_->sequence.store(seq + 2, std::memory_order_release);
+	}
+
+	// A consistent copy, or false if the updater has not written yet (or
+	// kept writing through every attempt).
+	bool read(Record & record, std::string & devices) const {
+		if (segment_->magic != MAGIC || segment_->layout != LAYOUT)
+			return false;
+		for (int attempt = 0; attempt < 100; ++attempt) {
+			uint64_t seq = segment_->sequence.load(std::memory_order_acquire);
+			if (seq == 0)
+				return false;
+			if (seq & 1) {
+				std::this_thread::yield();
+				continue;
+			}
+			load(&record, segment_->record, sizeof(record));
+			uint32_t bytes = std::min<uint32_t>(record.deviceBytes, CAPACITY);
+			devices.resize(bytes);
+			if (bytes)
+				load(&devices[0], segment_->devices, bytes);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (segment_->sequence.load(std::memory_order_relaxed) == seq)
+				return true;
+		}
+		return false;
+	}
+
+	// cereal portable binary of the devices, in interface order.
+	static std::string encodeDevices(const DeviceTable::map_type & devices) {
+		std::ostringstream os;
+		{
+			cereal::PortableBinaryOutputArchive archive(os);
+			archive(static_cast<uint32_t>(devices.size()));
+			for (DeviceTable::map_type::const_iterator itr = devices.begin(); itr != devices.end(); ++itr)
+				archive(*itr->second);
+		}
+		return os.str();
+	}
+
+	static DeviceTable::map_type decodeDevices(const std::string & bytes) {
+		DeviceTable::map_type devices;
+		std::istringstream is(bytes);
+		cereal::PortableBinaryInputArchive archive(is);
+		uint32_t n;
+		archive(n);
+		for (uint32_t i = 0; i < n; ++i) {
+			std::shared_ptr<DeviceInfo> device(new DeviceInfo());
+			archive(*device);
+			devices[device->interface] = device;
+		}
+		return devices;
+	}
+
+private:
+	enum { MAGIC = 0x4e455453, LAYOUT = 4 }; // "NETS"
+	enum { RECORD_WORDS = (sizeof(Record) + 7) / 8, DEVICE_WORDS = CAPACITY / 8 };
+
+	struct Segment {
+		uint32_t magic;
+		uint32_t layout;
+		std::atomic<uint64_t> sequence;
+		std::atomic<uint64_t> record[RECORD_WORDS];
+		std::atomic<uint64_t> devices[DEVICE_WORDS];
+	};
+
+	static void store(std::atomic<uint64_t> * words, const void * from, size_t n) {
+		const char * p = static_cast<const char *>(from);
+		for (size_t i = 0; i < n; i += 8) {
+			uint64_t w = 0;
+			memcpy(&w, p + i, std::min<size_t>(8, n - i));
+			words[i / 8].store(w, std::memory_order_relaxed);
+		}
+	}
+
+	static void load(void * to, const std::atomic<uint64_t> * words, size_t n) {
+		char * p = static_cast<char *>(to);
+		for (size_t i = 0; i < n; i += 8) {
+			uint64_t w = words[i / 8].load(std::memory_order_relaxed);
+			memcpy(p + i, &w, std::min<size_t>(8, n - i));
+		}
+	}
+
+	void fail(const std::string & path, const char * what) {
+		std::string message = path + ": " + what + ": " + strerror(errno);
+		if (fd_ >= 0)
+			close(fd_);
+		fd_ = -1;
+		throw std::runtime_error(message);
+	}
+
+	int fd_;
+	Segment * segment_;
+};
+
+// Updater side: writes the process's NetworkState and DeviceState to the
+// segment. Devices are only re-encoded when their generation moves.
+class SnapshotPublisher {
+public:
+	SnapshotPublisher(SharedSnapshot & segment, NetworkState & state, DeviceState & devices):
+	segment_(segment), state_(state), devices_(devices), deviceEpoch_(0), deviceGeneration_(0) {}
+
+	// Returns true if anything was written.
+	bool publish(const NetworkRefresher::Freshness & f, time_t now = time(0)) {
+		SharedSnapshot::Record record = SharedSnapshot::Record();
+		record.epoch = state_.epoch();
+		{
+			NetworkState::Reader reader(state_);
+			const NetworkSnapshot * snapshot = reader.snapshot();
+			if (snapshot) {
+				record.generation = snapshot->generation();
+				record.modified = snapshot->modified();
+				record.ipAddress = snapshot->data().getIPAddress();
+				record.netmask = snapshot->data().getNetMask();
+				record.gateway = snapshot->data().getGateWay();
+			}
+		}
+		{
+			DeviceState::Reader reader(devices_);
+			const DeviceTable * table = reader.table();
+			if (table && (table->epoch() != deviceEpoch_ || table->generation() != deviceGeneration_)) {
+				std::string encoded = SharedSnapshot::encodeDevices(table->devices());
+				if (encoded.size() <= SharedSnapshot::CAPACITY) {
+					encoded_.swap(encoded);
+					deviceEpoch_ = table->epoch();
+					deviceGeneration_ = table->generation();
+					devicesModified_ = table->modified();
+					devicesStale_ = false;
+				} else if (table->generation() != dropped_) {
+					std::cerr << "shared snapshot: " << table->size() << " devices encode to " << encoded.size()
+					          << " bytes, over the " << SharedSnapshot::CAPACITY << " the segment holds; followers keep "
+					          << (deviceGeneration_ ? "generation " + std::to_string(deviceGeneration_) : std::string("no devices"))
+					          << " and report them stale\n";
+					dropped_ = table->generation();
+					devicesStale_ = true;
+				}
+			}
+		}
+		record.deviceEpoch = deviceEpoch_;
+		record.deviceGeneration = deviceGeneration_;
+		record.devicesModified = devicesModified_;
+		record.devicesStale = devicesStale_;
+		record.confirmed = f.age < 0 ? 0 : now - f.age;
+		record.failed = f.failed;
+		if (written_ && sameRecord(record, last_))
+			return false;
+		segment_.write(record, encoded_);
+		last_ = record;
+		written_ = true;
+		return true;
+	}
+
+private:
+	static bool sameRecord(const SharedSnapshot::Record & a, const SharedSnapshot::Record & b) {
+		return a.epoch == b.epoch && a.generation == b.generation && a.confirmed == b.confirmed && a.failed == b.failed
+		    && a.deviceEpoch == b.deviceEpoch && a.deviceGeneration == b.deviceGeneration && a.devicesStale == b.devicesStale;
+	}
+
+	SharedSnapshot & segment_;
+	NetworkState & state_;
+	DeviceState & devices_;
+	uint64_t deviceEpoch_;
+	uint64_t deviceGeneration_;
+	time_t devicesModified_ = 0;
+	bool devicesStale_ = false;
+	uint64_t dropped_ = 0; // generation last found too large, logged once
+	std::string encoded_;
+	SharedSnapshot::Record last_;
+	bool written_ = false;
+};
+
+// Worker side: polls the segment's sequence and republishes what the
+// updater wrote into this process's NetworkState and DeviceState, so the
+// resources read them as usual, under the updater's epochs and generations
+// so that entity tags agree across processes. New generations are also
+// announced on the EventRing as "snapshot" events. A restarted updater
+// numbers from 1 again, so a new epoch is adopted whatever its generations.
+class SnapshotFollower {
+public:
+	SnapshotFollower(SharedSnapshot & segment, NetworkState & state, DeviceState & devices, EventRing * events = 0,
+	                 std::chrono::milliseconds interval = std::chrono::milliseconds(50), long maxAge = 10):
+	segment_(segment), state_(state), devices_(devices), events_(events), interval_(interval), maxAge_(maxAge),
+	seen_(0), epoch_(0), generation_(0), deviceEpoch_(0), deviceGeneration_(0), confirmed_(0), failed_(false),
+	devicesStale_(false), stopping_(false) {}
+
+	~SnapshotFollower() { stop(); }
+
+	void start() {
+		worker_ = std::thread(&SnapshotFollower::run, this);
+	}
+
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		wake_.notify_one();
+		if (worker_.joinable())
+			worker_.join();
+	}
+
+	// Copies the segment if the updater wrote since the last poll. Returns
+	// true if it did.
+	bool poll() {
+		uint64_t seq = segment_.sequence();
+		if (seq == seen_)
+			return false;
+		SharedSnapshot::Record record;
+		if (!segment_.read(record, bytes_))
+			return false;
+		seen_ = seq;
+		confirmed_.store(record.confirmed);
+		failed_.store(record.failed != 0);
+		devicesStale_.store(record.devicesStale != 0);
+		bool restarted = record.epoch != epoch_;
+		epoch_ = record.epoch;
+		if (record.generation && (restarted || record.generation != generation_)) {
+			state_.adopt(NetworkData(record.ipAddress, record.netmask, record.gateway), record.epoch, record.generation, record.modified);
+			generation_ = record.generation;
+			NetworkState::snapshot_pointer snapshot = state_.snapshot();
+			if (events_ && snapshot)
+				events_->publish("snapshot", snapshot->body());
+		}
+		if (record.deviceGeneration && (record.deviceEpoch != deviceEpoch_ || record.deviceGeneration != deviceGeneration_)) {
+			devices_.adopt(SharedSnapshot::decodeDevices(bytes_), record.deviceEpoch, record.deviceGeneration, record.devicesModified);
+			deviceEpoch_ = record.deviceEpoch;
+			deviceGeneration_ = record.deviceGeneration;
+		}
+		return true;
+	}
+
+	// As the updater's refresher reported it. An updater that stops
+	// writing shows as a growing age.
+	NetworkRefresher::Freshness freshness(time_t now = time(0)) const {
+		NetworkRefresher::Freshness f;
+		time_t confirmed = confirmed_.load();
+		f.failed = failed_.load();
+		f.age = confirmed ? static_cast<long>(now - confirmed) : -1;
+		f.stale = !confirmed || f.age > maxAge_ || f.failed;
+		return f;
+	}
+
+	// The updater's device table outgrew the segment; the DeviceState
+	// holds the last one that fit.
+	bool devicesStale() const {
+		return devicesStale_.load();
+	}
+
+private:
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (!stopping_) {
+			lock.unlock();
+			try {
+				poll();
+			} catch (const std::exception &) {
+				// undecodable devices: keep what we have, retry on the next write
+			}
+			lock.lock();
+			wake_.wait_for(lock, interval_, [this] { return stopping_; });
+		}
+	}
+
+	SharedSnapshot & segment_;
+	NetworkState & state_;
+	DeviceState & devices_;
+	EventRing * events_;
+	const std::chrono::milliseconds interval_;
+	const long maxAge_;
+	uint64_t seen_;
+	uint64_t epoch_;
+	uint64_t generation_;
+	uint64_t deviceEpoch_;
+	uint64_t deviceGeneration_;
+	std::string bytes_;
+	std::atomic<time_t> confirmed_;
+	std::atomic<bool> failed_;
+	std::atomic<bool> devicesStale_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	bool stopping_;
+	std::thread worker_;
+};
+#endif // SHARED_SNAPSHOT_H
@@ -0,0 +1,239 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Phase timings of requests, kept in memory and dumped on demand in the
+// Chrome trace event format (chrome://tracing, Perfetto). Every thread
+// records into a ring of its own, overwriting its oldest events, with
+// relaxed stores only; a Span costs two clock reads while enabled and one
+// relaxed load while not.
+//
+// Event names and categories are string literals: only the pointer is
+// stored, and they are written to the dump unescaped.
+class Tracer {
+	struct Ring;
+
+public:
+	typedef std::chrono::steady_clock clock;
+
+	enum { CAPACITY = 8192 }; // events kept per thread
+
+	// Enabled from the start with FCGIAPP_TRACE=1.
+	static Tracer & instance() {
+		static Tracer tracer;
+		return tracer;
+	}
+
+	Tracer(): id_(nextId()), enabled_(0) {}
+
+	~Tracer() {
+		for (size_t i = 0; i < rings_.size(); ++i)
+			delete rings_[i];
+	}
+
+	Tracer(const Tracer &) = delete;
+	Tracer & operator=(const Tracer &) = delete;
+
+	bool enabled() const { return enabled_.load(std::memory_order_relaxed) > 0; }
+
+	// Counted: tracing stays on until every enable() has been disabled.
+	void enable() { ++enabled_; }
+	void disable() { --enabled_; }
+
+	// Enabled for as long as it is in scope, e.g. while a dump is recorded.
+	class Recording {
+	public:
+		explicit Recording(Tracer & tracer = Tracer::instance()): tracer_(tracer), started_(clock::now()) { tracer_.enable(); }
+		~Recording() { tracer_.disable(); }
+
+		clock::time_point started() const { return started_; }
+
+	private:
+		Tracer & tracer_;
+		clock::time_point started_;
+	};
+
+	// A request on this thread: the events recorded meanwhile carry its
+	// number, as args.request in the dump.
+	class Request {
+	public:
+		explicit Request(Tracer & tracer = Tracer::instance()): ring_(tracer.enabled() ? &tracer.ring() : 0) {
+			if (ring_)
+				ring_->request = ++ring_->requests;
+		}
+		~Request() {
+			if (ring_)
+				ring_->request = 0;
+		}
+
+	private:
+		Ring * ring_;
+	};
+
+	// Times a phase from construction to destruction.
+	class Span {
+	public:
+		explicit Span(const char * name, const char * category = "request", Tracer & tracer = Tracer::instance()):
+		tracer_(tracer.enabled() ? &tracer : 0), name_(name), category_(category) {
+			if (tracer_)
+				begin_ = clock::now();
+		}
+		~Span() { end(); }
+
+		// Ends the phase before the end of the scope.
+		void end() {
+			if (tracer_)
+				tracer_->record(name_, category_, begin_, clock::now());
+			tracer_ = 0;
+		}
+
+	private:
+		Tracer * tracer_;
+		const char * name_;
+		const char * category_;
+		clock::time_point begin_;
+	};
+
+	// Records a finished phase on this thread's ring.
+	void record(const char * name, const char * category, clock::time_point begin, clock::time_point end) {
+		Ring & r = ring();
+		uint64_t n = r.published.load(std::memory_order_relaxed);
+		// Claim first, so a dump copying this slot meanwhile can tell.
+		r.claimed.store(n + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		Event & e = r.events[n % CAPACITY];
+		e.name.store(name, std::memory_order_relaxed);
+		e.category.store(category, std::memory_order_relaxed);
+		e.begin.store(nanos(begin), std::memory_order_relaxed);
+		e.duration.store(nanos(end) - nanos(begin), std::memory_order_relaxed);
+		e.request.store(r.request, std::memory_order_relaxed);
+		r.published.store(n + 1, std::memory_order_release);
+	}
+
+	// Complete ("X") events of every thread that began at or after since,
+	// as a JSON object with a traceEvents array.
+	std::string dump(clock::time_point since = clock::time_point::min()) const {
+		int64_t from = since == clock::time_point::min() ? INT64_MIN : nanos(since);
+		std::string out = "{\"traceEvents\":[";
+		bool first = true;
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (size_t i = 0; i < rings_.size(); ++i) {
+			std::vector<Copy> events = copy(*rings_[i]);
+			for (size_t j = 0; j < events.size(); ++j) {
+				if (events[j].begin < from)
+					continue;
+				char text[320];
+				int n = snprintf(text, sizeof(text),
+				                 "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld.%03d,\"dur\":%lld.%03d,\"pid\":%d,\"tid\":%d",
+				                 first ? "" : ",", events[j].name, events[j].category,
+				                 static_cast<long long>(events[j].begin / 1000), static_cast<int>(events[j].begin % 1000),
+				                 static_cast<long long>(events[j].duration / 1000), static_cast<int>(events[j].duration % 1000),
+				                 static_cast<int>(getpid()), rings_[i]->tid);
+				out.append(text, std::min(n, int(sizeof(text)) - 1));
+				if (events[j].request)
+					out += ",\"args\":{\"request\":" + std::to_string(events[j].request) + "}";
+				out += '}';
+				first = false;
+			}
+		}
+		out += "\n],\"displayTimeUnit\":\"ms\"}\n";
+		return out;
+	}
+
+private:
+	struct Event {
+		std::atomic<const char *> name;
+		std::atomic<const char *> category;
+		std::atomic<int64_t> begin; // ns
+		std::atomic<int64_t> duration; // ns
+		std::atomic<uint64_t> request;
+	};
+
+	struct Ring {
+		std::atomic<uint64_t> claimed;
+		std::atomic<uint64_t> published;
+		uint64_t request; // owner only
+		uint64_t requests;
+		int tid;
+		Event events[CAPACITY];
+
+		Ring(): claimed(0), published(0), request(0), requests(0), tid(static_cast<int>(syscall(SYS_gettid))) {}
+	};
+
+	struct Copy {
+		const char * name;
+		const char * category;
+		int64_t begin;
+		int64_t duration;
+		uint64_t request;
+	};
+
+	// The events of a ring, oldest first, leaving out any overwritten
+	// while they were copied.
+	static std::vector<Copy> copy(const Ring & r) {
+		uint64_t end = r.published.load(std::memory_order_acquire);
+		uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+		std::vector<Copy> events;
+		events.reserve(end - begin);
+		for (uint64_t n = begin; n < end; ++n) {
+			const Event & e = r.events[n % CAPACITY];
+			Copy c = { e.name.load(std::memory_order_relaxed), e.category.load(std::memory_order_relaxed),
+			           e.begin.load(std::memory_order_relaxed), e.duration.load(std::memory_order_relaxed),
+			           e.request.load(std::memory_order_relaxed) };
+			events.push_back(c);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t claimed = r.claimed.load(std::memory_order_relaxed);
+		uint64_t valid = claimed > CAPACITY ? claimed - CAPACITY : 0;
+		if (valid > begin)
+			events.erase(events.begin(), events.begin() + std::min(valid - begin, end - begin));
+		return events;
+	}
+
+	static int64_t nanos(clock::time_point t) {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+	}
+
+	// This thread's ring of this instance, created on first use, as the
+	// Metrics shards are.
+	Ring & ring() {
+		struct Owned {
+			uint64_t id;
+			Ring * ring;
+		};
+		static thread_local std::vector<Owned> owned;
+		for (size_t i = 0; i < owned.size(); ++i)
+			if (owned[i].id == id_)
+				return *owned[i].ring;
+		Ring * r = new Ring();
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			rings_.push_back(r);
+		}
+		Owned o = { id_, r };
+		owned.push_back(o);
+		return *r;
+	}
+
+	static uint64_t nextId() {
+		static std::atomic<uint64_t> id(0);
+		return ++id;
+	}
+
+	const uint64_t id_;
+	std::atomic<int> enabled_;
+	mutable std::mutex mutex_;
+	std::vector<Ring *> rings_;
+};
+#endif // TRACER_H
@@ -0,0 +1,31 @@
+#ifndef TRACINGREST_H
+#define TRACINGREST_H
+
+#include <restcgi/rest.h>
+
+#include "Tracer.h"
+
+// restcgi::rest with each step of process() traced as a phase of its own.
+class TracingRest : public restcgi::rest {
+protected:
+	bool special_case() {
+		Tracer::Span span("special_case");
+		return restcgi::rest::special_case();
+	}
+
+	resource_pointer locate(resource_pointer& r) {
+		Tracer::Span span("locate");
+		return restcgi::rest::locate(r);
+	}
+
+	void apply() {
+		Tracer::Span span("apply");
+		restcgi::rest::apply();
+	}
+
+	void on_exception(const restcgi::sc_ctmpls& sccts) {
+		Tracer::Span span("on_exception");
+		restcgi::rest::on_exception(sccts);
+	}
+};
+#endif //TRACINGREST_H
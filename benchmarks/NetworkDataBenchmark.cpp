@@ -0,0 +1,54 @@
+#include <sstream>
+
+#include <benchmark/benchmark.h>
+
+#include "../NetworkData.h"
+
+using namespace std;
+
+// The cereal path: a fresh stringstream and archive per call.
+static string cerealSerialize(NetworkData & data) {
+	std::stringstream ss;
+	{
+		cereal::JSONOutputArchive oarchive(ss);
+		oarchive(data);
+	}
+	return ss.str();
+}
+
+static void BM_CerealStringstream(benchmark::State & state) {
+	NetworkData data("172.17.0.1", "255.0.0.0", "192.168.1.1");
+	for (auto _ : state)
+		benchmark::DoNotOptimize(cerealSerialize(data));
+}
+BENCHMARK(BM_CerealStringstream);
+
+// What a snapshot pre-renders: JsonEncoder plus the {"value0": ...}
+// envelope, into a new string.
+static void BM_SerializeString(benchmark::State & state) {
+	NetworkData data("172.17.0.1", "255.0.0.0", "192.168.1.1");
+	for (auto _ : state)
+		benchmark::DoNotOptimize(data.serialize());
+}
+BENCHMARK(BM_SerializeString);
+
+// What a ?fields= response writes from: the same document in the thread's
+// encode() buffer.
+static void BM_EncodeBuffer(benchmark::State & state) {
+	NetworkData data("172.17.0.1", "255.0.0.0", "192.168.1.1");
+	for (auto _ : state)
+		benchmark::DoNotOptimize(data.encode().data());
+}
+BENCHMARK(BM_EncodeBuffer);
+
+// The compile-time member list, appended to a reused string.
+static void BM_JsonEncoder(benchmark::State & state) {
+	NetworkData data("172.17.0.1", "255.0.0.0", "192.168.1.1");
+	string out;
+	for (auto _ : state) {
+		out.clear();
+		data.encodeJson(out);
+		benchmark::DoNotOptimize(out.data());
+	}
+}
+BENCHMARK(BM_JsonEncoder);
@@ -0,0 +1,65 @@
+#include <memory>
+#include <mutex>
+
+#include <benchmark/benchmark.h>
+
+#include "../NetworkState.h"
+
+using namespace std;
+
+// The pre-RCU holder: a mutex around a shared_ptr copy.
+class MutexState {
+public:
+	NetworkState::snapshot_pointer snapshot() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return current_;
+	}
+	void publish(const NetworkState::snapshot_pointer & next) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		current_ = next;
+	}
+private:
+	mutable std::mutex mutex_;
+	NetworkState::snapshot_pointer current_;
+};
+
+static NetworkState & rcuState() {
+	static NetworkState state;
+	static bool initialized = state.update(NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1"));
+	(void) initialized;
+	return state;
+}
+
+static MutexState & mutexState() {
+	static MutexState state;
+	static bool initialized = (state.publish(rcuState().snapshot()), true);
+	(void) initialized;
+	return state;
+}
+
+static void BM_SnapshotMutex(benchmark::State & state) {
+	MutexState & s = mutexState();
+	for (auto _ : state) {
+		NetworkState::snapshot_pointer snapshot = s.snapshot();
+		benchmark::DoNotOptimize(snapshot->hash());
+	}
+}
+BENCHMARK(BM_SnapshotMutex)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_SnapshotSharedPtr(benchmark::State & state) {
+	NetworkState & s = rcuState();
+	for (auto _ : state) {
+		NetworkState::snapshot_pointer snapshot = s.snapshot();
+		benchmark::DoNotOptimize(snapshot->hash());
+	}
+}
+BENCHMARK(BM_SnapshotSharedPtr)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_SnapshotReader(benchmark::State & state) {
+	NetworkState & s = rcuState();
+	for (auto _ : state) {
+		NetworkState::Reader reader(s);
+		benchmark::DoNotOptimize(reader.snapshot()->hash());
+	}
+}
+BENCHMARK(BM_SnapshotReader)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,48 @@
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../PathTable.h"
+
+using namespace std;
+
+// A GetDevices reply's worth of object paths, back to back as they sit in
+// the message.
+static const vector<string> & replyPaths() {
+	static vector<string> paths;
+	if (paths.empty())
+		for (int i = 0; i < 10000; ++i)
+			paths.push_back("/org/freedesktop/NetworkManager/Devices/" + to_string(i));
+	return paths;
+}
+
+// What operator>>(std::vector< ::DBus::Path >) does: a string per path.
+static void BM_PathCopy(benchmark::State & state) {
+	const vector<string> & paths = replyPaths();
+	for (auto _ : state) {
+		vector<string> devices;
+		for (size_t i = 0; i < paths.size(); ++i)
+			devices.push_back(string(paths[i].c_str()));
+		benchmark::DoNotOptimize(devices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * paths.size());
+}
+BENCHMARK(BM_PathCopy);
+
+// Paths already known, as on every refresh after the first.
+static void BM_PathIntern(benchmark::State & state) {
+	const vector<string> & paths = replyPaths();
+	PathTable table;
+	for (size_t i = 0; i < paths.size(); ++i)
+		table.intern(paths[i]);
+	for (auto _ : state) {
+		vector<PathId> devices;
+		PathTable::Batch intern(table);
+		for (size_t i = 0; i < paths.size(); ++i)
+			devices.push_back(intern(paths[i].c_str(), paths[i].size()));
+		benchmark::DoNotOptimize(devices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * paths.size());
+}
+BENCHMARK(BM_PathIntern);
@@ -0,0 +1,25 @@
+#include <benchmark/benchmark.h>
+
+#include "../Tracer.h"
+
+// A phase probe while tracing is off: one relaxed load.
+static void BM_SpanDisabled(benchmark::State & state) {
+	Tracer tracer;
+	for (auto _ : state) {
+		Tracer::Span span("phase", "request", tracer);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_SpanDisabled);
+
+// While tracing: two clock reads and an event in this thread's ring. A
+// request goes through about ten phases.
+static void BM_SpanEnabled(benchmark::State & state) {
+	Tracer tracer;
+	tracer.enable();
+	for (auto _ : state) {
+		Tracer::Span span("phase", "request", tracer);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_SpanEnabled);
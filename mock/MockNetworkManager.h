@@ -0,0 +1,423 @@
+#ifndef MOCK_NETWORK_MANAGER_H
+#define MOCK_NETWORK_MANAGER_H
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <dbus-c++/dbus.h>
+
+#include "../NetworkAdaptor.h"
+
+// Stand-in for NetworkManager, served from /org/freedesktop/NetworkManager
+// on whatever bus it is constructed with. Device and active connection
+// counts, a per-call latency and a scripted signal storm are configurable,
+// so the request path can be exercised without a real NetworkManager.
+struct MockOptions {
+	size_t devices;
+	size_t connections;
+	int latencyMs;       // added to every method call and property read
+	double stormRate;    // signals per second, 0 for none
+	int stormSeconds;
+	int stormDelaySeconds;
+
+	MockOptions(): devices(4), connections(1), latencyMs(0), stormRate(0), stormSeconds(0), stormDelaySeconds(0) {}
+};
+
+// dbus-c++'s PropertiesAdaptor only answers Get and Set; the property
+// mirror loads everything with GetAll. Get is answered from GetAll as well:
+// dbus-c++'s own Get serializes the stored value after returning from
+// on_get_property(), where no lock of ours can cover it.
+class MockProperties : public DBus::PropertiesAdaptor
+{
+public:
+	MockProperties()
+	{
+		register_method(MockProperties, GetAll, _GetAll_stub);
+		register_method(MockProperties, Get, _Get_stub);
+	}
+
+	virtual void GetAll(const std::string & interface, std::map< std::string, ::DBus::Variant > & props) = 0;
+
+private:
+	::DBus::Message _Get_stub(const ::DBus::CallMessage &call)
+	{
+		::DBus::MessageIter ri = call.reader();
+
+		std::string interface, property;
+		ri >> interface >> property;
+		std::map< std::string, ::DBus::Variant > props;
+		GetAll(interface, props);
+		std::map< std::string, ::DBus::Variant >::const_iterator found = props.find(property);
+		if (found == props.end())
+			throw DBus::Error("org.freedesktop.DBus.Error.UnknownProperty", "no such property");
+		::DBus::ReturnMessage reply(call);
+		::DBus::MessageIter wi = reply.writer();
+		wi << found->second;
+		return reply;
+	}
+
+	::DBus::Message _GetAll_stub(const ::DBus::CallMessage &call)
+	{
+		::DBus::MessageIter ri = call.reader();
+
+		std::string argin1; ri >> argin1;
+		std::map< std::string, ::DBus::Variant > argout1;
+		GetAll(argin1, argout1);
+		::DBus::ReturnMessage reply(call);
+		::DBus::MessageIter wi = reply.writer();
+		wi << argout1;
+		return reply;
+	}
+};
+
+// One mock device: its Device properties at /Devices/<n> and its
+// IP4Config at /IP4Config/<n>, both answering GetAll. Interface eth<n>
+// with address 10.<n>/8 (the low three bytes of n).
+class MockDevice : public DBus::IntrospectableAdaptor,
+				public MockProperties,
+				public DBus::ObjectAdaptor
+{
+public:
+	MockDevice(DBus::Connection &connection, const ::DBus::Path &path, size_t n, int latencyMs):
+	DBus::ObjectAdaptor(connection, path), n_(n), latencyMs_(latencyMs), ip4config_(connection, ip4Path(n), n, latencyMs)
+	{
+	}
+
+	void GetAll(const std::string & interface, std::map< std::string, ::DBus::Variant > & props) {
+		delay(latencyMs_);
+		if (interface != "org.freedesktop.NetworkManager.Device")
+			return;
+		std::ostringstream name;
+		name << "eth" << n_;
+		props["Interface"] = variant<std::string>(name.str());
+		props["IpInterface"] = variant<std::string>(name.str());
+		props["Driver"] = variant<std::string>("mock");
+		props["State"] = variant<uint32_t>(100); // NM_DEVICE_STATE_ACTIVATED
+		props["DeviceType"] = variant<uint32_t>(1); // NM_DEVICE_TYPE_ETHERNET
+		props["Mtu"] = variant<uint32_t>(1500);
+		props["Managed"] = variant<bool>(true);
+		props["Ip4Config"] = variant< ::DBus::Path >(ip4Path(n_));
+	}
+
+	template<class T>
+	static ::DBus::Variant variant(const T & value) {
+		::DBus::Variant v;
+		::DBus::MessageIter vi = v.writer();
+		vi << value;
+		return v;
+	}
+
+	static void delay(int latencyMs) {
+		if (latencyMs > 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+	}
+
+private:
+	class IP4Config : public DBus::IntrospectableAdaptor,
+				public MockProperties,
+				public DBus::ObjectAdaptor
+	{
+	public:
+		IP4Config(DBus::Connection &connection, const ::DBus::Path &path, size_t n, int latencyMs):
+		DBus::ObjectAdaptor(connection, path), n_(n), latencyMs_(latencyMs)
+		{
+		}
+
+		void GetAll(const std::string & interface, std::map< std::string, ::DBus::Variant > & props) {
+			delay(latencyMs_);
+			if (interface != "org.freedesktop.NetworkManager.IP4Config")
+				return;
+			std::ostringstream address;
+			address << "10." << (n_ >> 16 & 0xff) << '.' << (n_ >> 8 & 0xff) << '.' << (n_ & 0xff);
+			std::map< std::string, ::DBus::Variant > data;
+			data["address"] = variant<std::string>(address.str());
+			data["prefix"] = variant<uint32_t>(8);
+			props["AddressData"] = variant< std::vector< std::map< std::string, ::DBus::Variant > > >(
+				std::vector< std::map< std::string, ::DBus::Variant > >(1, data));
+			props["Gateway"] = variant<std::string>("10.255.255.254");
+			props["Nameservers"] = variant< std::vector<uint32_t> >(std::vector<uint32_t>(1, htonl(0x0a0000fe)));
+		}
+
+	private:
+		size_t n_;
+		int latencyMs_;
+	};
+
+	static ::DBus::Path ip4Path(size_t n) {
+		std::ostringstream os;
+		os << "/org/freedesktop/NetworkManager/IP4Config/" << n;
+		return os.str();
+	}
+
+	size_t n_;
+	int latencyMs_;
+	IP4Config ip4config_;
+};
+
+class MockNetworkManager : public org::freedesktop::NetworkManager_adaptor,
+				public DBus::IntrospectableAdaptor,
+				public MockProperties,
+				public DBus::ObjectAdaptor
+{
+public:
+	enum { NM_STATE_ASLEEP = 10, NM_STATE_DISCONNECTED = 20, NM_STATE_CONNECTED_GLOBAL = 70 };
+	enum { NM_CONNECTIVITY_FULL = 4 };
+
+	MockNetworkManager(DBus::Connection &connection, const MockOptions &options):
+	DBus::ObjectAdaptor(connection, "/org/freedesktop/NetworkManager"), options_(options), nextActive_(0)
+	{
+		for (size_t i = 0; i < options_.devices; ++i) {
+			devices_.push_back(devicePath(i));
+			deviceObjects_.push_back(std::unique_ptr<MockDevice>(new MockDevice(connection, devicePath(i), i, options_.latencyMs)));
+		}
+		std::vector< ::DBus::Path > active;
+		for (size_t i = 0; i < options_.connections; ++i)
+			active.push_back(activePath(nextActive_++));
+
+		Connectivity = static_cast<uint32_t>(NM_CONNECTIVITY_FULL);
+		State = static_cast<uint32_t>(active.empty() ? NM_STATE_DISCONNECTED : NM_STATE_CONNECTED_GLOBAL);
+		Version = std::string("1.0.0-mock");
+		ActivatingConnection = ::DBus::Path("/");
+		PrimaryConnection = active.empty() ? ::DBus::Path("/") : active.front();
+		ActiveConnections = active;
+		WimaxHardwareEnabled = false;
+		WimaxEnabled = false;
+		WwanHardwareEnabled = false;
+		WwanEnabled = false;
+		WirelessHardwareEnabled = true;
+		WirelessEnabled = true;
+		NetworkingEnabled = true;
+	}
+
+	~MockNetworkManager() {
+		if (storm_.joinable())
+			storm_.join();
+	}
+
+	// Starts the scripted signal storm, if any, on its own thread.
+	void startStorm() {
+		if (options_.stormRate > 0 && options_.stormSeconds > 0)
+			storm_ = std::thread(&MockNetworkManager::runStorm, this);
+	}
+
+	uint32_t state() {
+		delay();
+		std::lock_guard<std::mutex> lock(mutex_);
+		return State;
+	}
+
+	uint32_t CheckConnectivity() {
+		delay();
+		std::lock_guard<std::mutex> lock(mutex_);
+		return Connectivity;
+	}
+
+	void GetLogging(std::string& level, std::string& domains) {
+		delay();
+		level = "INFO";
+		domains = "PLATFORM,CORE";
+	}
+
+	void SetLogging(const std::string& level, const std::string& domains) {
+		delay();
+	}
+
+	std::map< std::string, std::string > GetPermissions() {
+		delay();
+		std::map< std::string, std::string > permissions;
+		permissions["org.freedesktop.NetworkManager.enable-disable-network"] = "yes";
+		return permissions;
+	}
+
+	void Enable(const bool& enable) {
+		delay();
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			NetworkingEnabled = enable;
+		}
+		setState(enable ? NM_STATE_CONNECTED_GLOBAL : NM_STATE_DISCONNECTED);
+	}
+
+	void Sleep(const bool& sleep) {
+		delay();
+		setState(sleep ? NM_STATE_ASLEEP : NM_STATE_CONNECTED_GLOBAL);
+	}
+
+	void DeactivateConnection(const ::DBus::Path& active_connection) {
+		delay();
+		std::vector< ::DBus::Path > active;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			active = ActiveConnections;
+			std::vector< ::DBus::Path >::iterator itr = std::find(active.begin(), active.end(), active_connection);
+			if (itr == active.end())
+				throw DBus::Error("org.freedesktop.NetworkManager.ConnectionNotActive", "connection is not active");
+			active.erase(itr);
+			setActive(active);
+		}
+		activeChanged(active);
+	}
+
+	void AddAndActivateConnection(const std::map< std::string, std::map< std::string, ::DBus::Variant > >& connection,
+	                              const ::DBus::Path& device, const ::DBus::Path& specific_object,
+	                              ::DBus::Path& path, ::DBus::Path& active_connection) {
+		path = "/org/freedesktop/NetworkManager/Settings/0";
+		active_connection = ActivateConnection(path, device, specific_object);
+	}
+
+	::DBus::Path ActivateConnection(const ::DBus::Path& connection, const ::DBus::Path& device, const ::DBus::Path& specific_object) {
+		delay();
+		std::vector< ::DBus::Path > active;
+		::DBus::Path path;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			path = activePath(nextActive_++);
+			active = ActiveConnections;
+			active.push_back(path);
+			setActive(active);
+		}
+		activeChanged(active);
+		return path;
+	}
+
+	::DBus::Path GetDeviceByIpIface(const std::string& iface) {
+		delay();
+		size_t n = 0;
+		std::istringstream is(iface.size() > 3 && iface.compare(0, 3, "eth") == 0 ? iface.substr(3) : std::string());
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!(is >> n) || n >= devices_.size())
+			throw DBus::Error("org.freedesktop.NetworkManager.UnknownDevice", "no device for that interface");
+		return devices_[n];
+	}
+
+	std::vector< ::DBus::Path > GetDevices() {
+		delay();
+		std::lock_guard<std::mutex> lock(mutex_);
+		return devices_;
+	}
+
+	void GetAll(const std::string & interface, std::map< std::string, ::DBus::Variant > & props) {
+		delay();
+		if (interface != "org.freedesktop.NetworkManager")
+			return;
+		std::lock_guard<std::mutex> lock(mutex_);
+		props["Connectivity"] = variant<uint32_t>(Connectivity);
+		props["State"] = variant<uint32_t>(State);
+		props["Version"] = variant<std::string>(Version);
+		props["ActivatingConnection"] = variant< ::DBus::Path >(ActivatingConnection);
+		props["PrimaryConnection"] = variant< ::DBus::Path >(PrimaryConnection);
+		props["ActiveConnections"] = variant< std::vector< ::DBus::Path > >(ActiveConnections);
+		props["WimaxHardwareEnabled"] = variant<bool>(WimaxHardwareEnabled);
+		props["WimaxEnabled"] = variant<bool>(WimaxEnabled);
+		props["WwanHardwareEnabled"] = variant<bool>(WwanHardwareEnabled);
+		props["WwanEnabled"] = variant<bool>(WwanEnabled);
+		props["WirelessHardwareEnabled"] = variant<bool>(WirelessHardwareEnabled);
+		props["WirelessEnabled"] = variant<bool>(WirelessEnabled);
+		props["NetworkingEnabled"] = variant<bool>(NetworkingEnabled);
+	}
+
+private:
+	template<class T>
+	static ::DBus::Variant variant(const T & value) {
+		::DBus::Variant v;
+		::DBus::MessageIter vi = v.writer();
+		vi << value;
+		return v;
+	}
+
+	static ::DBus::Path devicePath(size_t n) {
+		std::ostringstream os;
+		os << "/org/freedesktop/NetworkManager/Devices/" << n;
+		return os.str();
+	}
+
+	static ::DBus::Path activePath(size_t n) {
+		std::ostringstream os;
+		os << "/org/freedesktop/NetworkManager/ActiveConnection/" << n;
+		return os.str();
+	}
+
+	void delay() {
+		if (options_.latencyMs > 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(options_.latencyMs));
+	}
+
+	void setState(uint32_t state) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			State = state;
+		}
+		std::map< std::string, ::DBus::Variant > changed;
+		changed["State"] = variant<uint32_t>(state);
+		PropertiesChanged(changed);
+		StateChanged(state);
+	}
+
+	// With mutex_ held.
+	void setActive(const std::vector< ::DBus::Path > & active) {
+		ActiveConnections = active;
+		PrimaryConnection = primary(active);
+	}
+
+	// Without it: signals go out on the bus.
+	void activeChanged(const std::vector< ::DBus::Path > & active) {
+		std::map< std::string, ::DBus::Variant > changed;
+		changed["ActiveConnections"] = variant< std::vector< ::DBus::Path > >(active);
+		changed["PrimaryConnection"] = variant< ::DBus::Path >(primary(active));
+		PropertiesChanged(changed);
+	}
+
+	static ::DBus::Path primary(const std::vector< ::DBus::Path > & active) {
+		return active.empty() ? ::DBus::Path("/") : active.front();
+	}
+
+	// Cycles through device hot-plug, state and property changes at
+	// stormRate signals per second for stormSeconds.
+	void runStorm() {
+		std::this_thread::sleep_for(std::chrono::seconds(options_.stormDelaySeconds));
+		const std::chrono::nanoseconds interval(static_cast<long long>(1e9 / options_.stormRate));
+		const long long total = static_cast<long long>(options_.stormRate * options_.stormSeconds);
+		std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+		for (long long i = 0; i < total; ++i) {
+			::DBus::Path device = devicePath(options_.devices + static_cast<size_t>(i / 4));
+			switch (i % 4) {
+			case 0: {
+				std::lock_guard<std::mutex> lock(mutex_);
+				devices_.push_back(device);
+			}
+				DeviceAdded(device);
+				break;
+			case 1: {
+				std::lock_guard<std::mutex> lock(mutex_);
+				devices_.pop_back();
+			}
+				DeviceRemoved(device);
+				break;
+			case 2:
+				setState(NM_STATE_DISCONNECTED);
+				break;
+			default:
+				setState(NM_STATE_CONNECTED_GLOBAL);
+				break;
+			}
+			next += interval;
+			std::this_thread::sleep_until(next);
+		}
+	}
+
+	MockOptions options_;
+	std::mutex mutex_; // devices_ and every property read and write; the storm runs on its own thread
+	std::vector< ::DBus::Path > devices_;
+	std::vector< std::unique_ptr<MockDevice> > deviceObjects_; // storm-added devices have none
+	size_t nextActive_;
+	std::thread storm_;
+};
+#endif // MOCK_NETWORK_MANAGER_H
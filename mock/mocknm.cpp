@@ -0,0 +1,64 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "MockNetworkManager.h"
+
+using namespace std;
+
+DBus::BusDispatcher dispatcher;
+
+static void usage() {
+	cerr << "usage: mocknm [--address <bus address>] [--devices N] [--connections N]\n"
+	     << "              [--latency-ms N] [--storm <signals/s>:<seconds>] [--storm-delay <seconds>]\n"
+	     << "Serves org.freedesktop.NetworkManager on the session bus, or on the bus\n"
+	     << "at --address (e.g. a private dbus-daemon).\n";
+}
+
+int main(int argc, char ** argv) {
+	MockOptions options;
+	const char * address = 0;
+
+	for (int i = 1; i < argc; ++i) {
+		const char * value = i + 1 < argc ? argv[i + 1] : 0;
+		if (!value) {
+			usage();
+			return 2;
+		}
+		if (!strcmp(argv[i], "--address"))
+			address = value;
+		else if (!strcmp(argv[i], "--devices"))
+			options.devices = strtoul(value, 0, 10);
+		else if (!strcmp(argv[i], "--connections"))
+			options.connections = strtoul(value, 0, 10);
+		else if (!strcmp(argv[i], "--latency-ms"))
+			options.latencyMs = atoi(value);
+		else if (!strcmp(argv[i], "--storm")) {
+			options.stormRate = atof(value);
+			const char * colon = strchr(value, ':');
+			options.stormSeconds = colon ? atoi(colon + 1) : 1;
+		} else if (!strcmp(argv[i], "--storm-delay"))
+			options.stormDelaySeconds = atoi(value);
+		else {
+			usage();
+			return 2;
+		}
+		++i;
+	}
+
+	DBus::_init_threading();
+	DBus::default_dispatcher = &dispatcher;
+
+	DBus::Connection bus = address ? DBus::Connection(address) : DBus::Connection::SessionBus();
+	if (address)
+		bus.register_bus();
+	bus.request_name("org.freedesktop.NetworkManager");
+
+	MockNetworkManager nm(bus, options);
+	nm.startStorm();
+	cerr << "mocknm: " << options.devices << " devices, " << options.connections
+	     << " active connections, " << options.latencyMs << "ms latency\n";
+
+	dispatcher.enter();
+	return 0;
+}
@@ -20,6 +20,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 #include "exception.h"
+#include <uripp/utils.h>
 namespace restcgi {
     const char* exception::VARIABLE_NAME_PREFIX = "exception_";
     exception::exception(const status_code_e& sc, const std::string& errmsg) throw()
@@ -91,6 +92,10 @@ namespace restcgi {
     gone::gone(const std::string& errmsg) throw()
         : exception(STATUS_CODE, errmsg.empty() ? std::string("resource is no longer available and address is not known") : errmsg) {
     }
+    const status_code_e not_acceptable::STATUS_CODE = status_code_e::NOT_ACCEPTABLE;
+    not_acceptable::not_acceptable(const std::string& errmsg) throw()
+        : exception(STATUS_CODE, errmsg.empty() ? std::string("none of the acceptable media types is available") : errmsg) {
+    }
     const status_code_e precondition_failed::STATUS_CODE = status_code_e::PRECONDITION_FAILED;
     precondition_failed::precondition_failed(const std::string& errmsg) throw()
         : exception(STATUS_CODE, errmsg) {
@@ -107,4 +112,15 @@ namespace restcgi {
     internal_server_error::internal_server_error(const std::string& errmsg) throw()
         : exception(STATUS_CODE, errmsg) {
     }
+    const status_code_e service_unavailable::STATUS_CODE = status_code_e::SERVICE_UNAVAILABLE;
+    service_unavailable::service_unavailable(const std::string& errmsg, size_t retry_after) throw()
+        : exception(STATUS_CODE, errmsg.empty() ? std::string("service temporarily unavailable") : errmsg), retry_after_(retry_after) {
+        if (retry_after_)
+            exception_insert("retry_after", uripp::convert(retry_after_));
+    }
+    service_unavailable::~service_unavailable() throw() {}
+    void service_unavailable::copy_hdr_flds(map_type& map) const {
+        if (retry_after_)
+            map.insert(std::make_pair("retry-after", uripp::convert(retry_after_)));
+    }
 }
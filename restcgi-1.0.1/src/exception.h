@@ -194,6 +194,14 @@ namespace restcgi {
         gone(const std::string& errmsg = "") throw();
         static const status_code_e STATUS_CODE; ///< status code for exception
     };
+    /** \brief "Not acceptable" exception.
+     * @see status_code_e::NOT_ACCEPTABLE */
+    class RESTCGI_API not_acceptable : public exception {
+    public:
+        /// Construct with optional, replacement errmsg.
+        not_acceptable(const std::string& errmsg = "") throw();
+        static const status_code_e STATUS_CODE; ///< status code for exception
+    };
     /** \brief "Precondition failed" exception.
      * @see status_code_e::PRECONDITION_FAILED */
     class RESTCGI_API precondition_failed : public exception {
@@ -226,5 +234,19 @@ namespace restcgi {
         internal_server_error(const std::string& errmsg = "") throw();
         static const status_code_e STATUS_CODE; ///< status code for exception
     };
+    /** \brief "Service unavailable" exception.
+     * @see status_code_e::SERVICE_UNAVAILABLE */
+    class RESTCGI_API service_unavailable : public exception {
+    public:
+        /// Construct with optional, replacement errmsg and optional
+        /// retry-after seconds (0 means do not send Retry-After).
+        service_unavailable(const std::string& errmsg = "", size_t retry_after = 0) throw();
+        ~service_unavailable() throw();
+        void copy_hdr_flds(map_type& map) const; ///< Copy hdr field name and values.
+        size_t retry_after() const {return retry_after_;} ///< Get retry-after seconds.
+        static const status_code_e STATUS_CODE; ///< status code for exception
+    private:
+        size_t retry_after_;
+    };
 }
 #endif
@@ -27,6 +27,8 @@ THE SOFTWARE.
 #include <boost/shared_ptr.hpp>
 #include <boost/algorithm/string.hpp>
 #include <sstream>
+#include <vector>
+#include <stdlib.h>
 #define ARRAY_SIZE(a) (sizeof(a)/sizeof(a[0]))
 enum fld_e {
     // THIS MUST BE IN SYNC WITH flds_traits_!!!
@@ -263,6 +265,78 @@ namespace restcgi {
     bool general_hdr::warning(const std::string& v) {return insert(E_WARNING, v);}
     request_hdr::request_hdr() : general_hdr(fc_request) {}
     std::string request_hdr::accept() const {return find(E_ACCEPT);}
+    namespace {
+        struct media_range {
+            std::string type;
+            std::string subtype;
+            double q;
+        };
+        void parse_accept(const std::string& s, std::vector<media_range>& ranges) {
+            std::vector<std::string> elems;
+            boost::split(elems, s, boost::is_any_of(","));
+            for (std::vector<std::string>::iterator it = elems.begin(); it != elems.end(); ++it) {
+                std::vector<std::string> params;
+                boost::split(params, *it, boost::is_any_of(";"));
+                std::string mt = boost::trim_copy(params.front());
+                std::string::size_type slash = mt.find('/');
+                if (slash == std::string::npos)
+                    continue;
+                media_range r;
+                r.type = boost::to_lower_copy(mt.substr(0, slash));
+                r.subtype = boost::to_lower_copy(mt.substr(slash + 1));
+                r.q = 1;
+                for (size_t i = 1; i < params.size(); ++i) {
+                    std::string p = boost::trim_copy(params[i]);
+                    if (p.size() > 2 && (p[0] == 'q' || p[0] == 'Q') && p[1] == '=') {
+                        r.q = atof(p.c_str() + 2);
+                        if (r.q < 0 || r.q > 1)
+                            r.q = 0;
+                        break; // accept-extensions follow q
+                    }
+                }
+                ranges.push_back(r);
+            }
+        }
+    }
+    std::string request_hdr::accept_select(const char* const* offered) const {
+        if (!offered || !*offered)
+            return std::string();
+        std::string s = accept();
+        if (boost::trim_copy(s).empty())
+            return *offered;
+        std::vector<media_range> ranges;
+        parse_accept(s, ranges);
+        std::string best;
+        double best_q = 0;
+        for (; *offered; ++offered) {
+            std::string mt = boost::to_lower_copy(std::string(*offered));
+            std::string::size_type slash = mt.find('/');
+            std::string type = mt.substr(0, slash);
+            std::string subtype = slash == std::string::npos ? std::string() : mt.substr(slash + 1);
+            int specificity = -1;
+            double q = 0;
+            for (std::vector<media_range>::const_iterator it = ranges.begin(); it != ranges.end(); ++it) {
+                int sp;
+                if (it->type == type && it->subtype == subtype)
+                    sp = 2;
+                else if (it->type == type && it->subtype == "*")
+                    sp = 1;
+                else if (it->type == "*" && it->subtype == "*")
+                    sp = 0;
+                else
+                    continue;
+                if (sp > specificity) {
+                    specificity = sp;
+                    q = it->q;
+                }
+            }
+            if (q > best_q) {
+                best_q = q;
+                best = *offered;
+            }
+        }
+        return best;
+    }
     std::string request_hdr::accept_charset() const {return find(E_ACCEPT_CHARSET);}
     std::string request_hdr::accept_encoding() const {return find(E_ACCEPT_ENCODING);}
     std::string request_hdr::accept_language() const {return find(E_ACCEPT_LANGUAGE);}
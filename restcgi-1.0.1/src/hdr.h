@@ -214,6 +214,16 @@ namespace restcgi {
     public:
         request_hdr(); ///< construct
         std::string accept() const; ///< get accept
+        /** \brief Select the media type to respond with from offered.
+         *
+         * offered is a null-terminated list of "type/subtype" in server
+         * preference order. Each is given the q-value of the most specific
+         * Accept range matching it (type/subtype over type/&#42; over
+         * &#42;/&#42;), and the first with the highest non-zero q-value is
+         * returned. Without an Accept field the first offered type is
+         * returned; if nothing is acceptable the empty string is.
+         * @see http://www.w3.org/Protocols/rfc2616/rfc2616-sec14.html#sec14.1 */
+        std::string accept_select(const char* const* offered) const;
         std::string accept_charset() const; ///< get accept charset
         std::string accept_encoding() const; ///< get accept encoding
         std::string accept_language() const; ///< get accept language
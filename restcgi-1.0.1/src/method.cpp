@@ -70,6 +70,7 @@ namespace restcgi {
         if (responded_)
             throw std::domain_error("method response already attempted");
         responded_ = true;
+        status_code_ = sc;
         respond(endpoint_, sc, rh, ch);
         if (has_content)
             ocontent_.reset(new ocontent_type(endpoint_, ch));
@@ -98,6 +98,7 @@ namespace restcgi {
          * @exception std::domain_error if already responded */
         ocontent_pointer respond(const content_hdr& ch, const status_code_e& sc = status_code_e::OK, const response_hdr_type& rh = response_hdr_type());
         bool responded() const {return responded_;} ///< Test if responded.
+        const status_code_e& status_code() const {return status_code_;} ///< Get status code responded with (null until responded).
         const env_type& env() const; ///< Get environment.
         endpoint_pointer endpoint() const {return endpoint_;} ///< Get endpoint.
         static const char QP_REST_PUT[8]; ///< query param for PUT method ("restPUT")
@@ -117,6 +118,7 @@ namespace restcgi {
         uri_path_type uri_path_;
         uri_query_type uri_query_;
         bool responded_;
+        status_code_e status_code_;
         request_hdr_type request_hdr_;
         icontent_pointer icontent_;
         ocontent_pointer ocontent_;
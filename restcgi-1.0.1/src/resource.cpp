@@ -52,6 +52,7 @@ namespace restcgi {
             method_->respond(sc, rh);
         } else {
             content_hdr ch;
+            render();
             on_responding(sc, rh, ch);
             ocontent::pointer oc = method_->respond(ch, sc, rh);
             write(oc);
@@ -88,6 +89,7 @@ namespace restcgi {
             method_->respond(sc, rh);
         } else {
             content_hdr ch;
+            cr->render();
             cr->on_responding(sc, rh, ch);
             ocontent::pointer oc = method_->respond(ch, sc, rh);
             cr->write(oc);
@@ -114,7 +116,7 @@ namespace restcgi {
     }
     void resource::head_method() {
         setup();
-        // Do what GET would do but w/o write.
+        // Do what GET would do but w/o render and write.
         version_type v = read(false);
         version_constraint_.assert_satisfied(v, me());
         status_code_e sc = status_code_e::OK;
@@ -149,6 +151,7 @@ namespace restcgi {
     void resource::del() {
         throw internal_server_error("resource::del not implemented by application");
     }
+    void resource::render() {}
     void resource::on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {}
     void resource::write(ocontent::pointer oc) {}
     void copy(const request_hdr& rh, version_constraint& vc) {
@@ -128,11 +128,15 @@ namespace restcgi {
         ///     satisfied.</li>
         /// <li>Initialize status code (OK) and response hdr (with version
         ///     info).</li>
+        /// <li>render(): Produce the representation (optional). (Not called
+        ///     if default_response set.)</li>
         /// <li>on_responding(): Modify status, response and content hdrs
         ///     (optional). (Not called if default_response set.)</li>
         /// <li>write(): Write to content stream (optional but customary).
         ///     (Not called if default_response set.)</li>
         /// </ol>
+        /// Note that render() is not reached when the constraint results
+        /// in not_modified, so a 304 never produces the representation.
         /// @see http://www.w3.org/Protocols/rfc2616/rfc2616-sec9.html#sec9.3
         virtual void get_method();
         /// Update the resource with the input content and, optionally,
@@ -148,6 +152,8 @@ namespace restcgi {
         ///     save to application store (required).</li>
         /// <li>Initialize status code (OK) and response hdr (with version
         ///     info).</li>
+        /// <li>render(): Produce the representation (optional). (Not called
+        ///     if default_response set.)</li>
         /// <li>on_responding(): Modify status, response and content hdrs
         ///     (optional). (Not called if default_response set.)</li>
         /// <li>write(): Write to content stream (optional).
@@ -169,6 +175,8 @@ namespace restcgi {
         ///     <li>Initialize status code (CREATED) and response hdr
         ///         (with version info and content-location to this uri path
         ///         appended with the returned id).</li>
+        ///     <li>render(): Produce the representation (optional).
+        ///         (Not called if child default_response set.)</li>
         ///     <li>on_responding(): Modify status, response and content hdrs
         ///         (optional). (Not called if child default_response set.)</li>
         ///     <li>write(): Write to content stream (optional).
@@ -190,6 +198,8 @@ namespace restcgi {
         /// <li>del(): Delete the resource from the application store
         ///     (required).</li>
         /// <li>Initialize status code (OK).</li>
+        /// <li>render(): Produce the representation (optional). (Not called
+        ///     if default_response set.)</li>
         /// <li>on_responding(): Modify status, response hdr (optional).
         ///     (Not called if default_response set.)</li>
         /// <li>write(): Write to content stream (optional).
@@ -232,6 +242,9 @@ namespace restcgi {
         /// <li>on_responding(): Modify status, response and content hdrs
         ///     (optional).</li>
         /// </ol>
+        /// render() and write() are never called, so the representation is
+        /// not produced. on_responding() should only describe it from what
+        /// read() returned (see render()).
         /// @see http://www.w3.org/Protocols/rfc2616/rfc2616-sec9.html#sec9.4
         virtual void head_method();
         int methods_allowed_mask() const {return methods_allowed_mask_;} ///< Get methods-allowed mask.
@@ -307,6 +320,27 @@ namespace restcgi {
         /// Default is to throw internal_server_error.
         /// @exception exception application can throw any exception
         virtual void del();
+        /** Produce the representation of the resource that write() will
+         * send. This is the body phase of a response and is only called
+         * when content is actually going to be sent, i.e. never for HEAD
+         * and never when a version constraint results in not_modified. It
+         * is called before on_responding() so that the content hdrs, e.g.
+         * content-length, can be taken from the rendered representation.
+         *
+         * Resources should keep read() and on_responding() to the metadata
+         * phase (version, type and, if cheaply known, length) and do the
+         * expensive encoding here:
+         * \code
+         * void render() {body_ = encode(data_);}
+         * void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
+         *     ch.content_type("application/json");
+         *     if (me() != method_e::HEAD)
+         *         ch.content_length(body_.size());
+         * }
+         * \endcode
+         *
+         * Default is to do nothing. */
+        virtual void render();
         /** Modify status code and response and content hdrs prior to
          * responding. This class sends the response but calls this
          * before doing it so that the derived class can add header fields,
@@ -97,9 +97,30 @@ static void test_cookie() {
         TEST_ASSERT(++it == h.end());
     }
 }
+static std::string select(const char* accept) {
+    static const char* offered[] = {"application/json", "application/x-cereal-portable-binary", 0};
+    request_hdr h;
+    if (accept)
+        h.insert("accept", accept);
+    return h.accept_select(offered);
+}
+static void test_accept_select() {
+    TEST_ASSERT(select(0) == "application/json");
+    TEST_ASSERT(select("*/*") == "application/json");
+    TEST_ASSERT(select("application/x-cereal-portable-binary") == "application/x-cereal-portable-binary");
+    TEST_ASSERT(select("application/json;q=0.5, application/x-cereal-portable-binary") == "application/x-cereal-portable-binary");
+    TEST_ASSERT(select("Application/*;q=0.2, application/json;q=0.1") == "application/x-cereal-portable-binary");
+    TEST_ASSERT(select("*/*;q=0.1, application/json;q=0") == "application/x-cereal-portable-binary");
+    TEST_ASSERT(select("text/html") == "");
+    TEST_ASSERT(select("text/html, */*;q=0") == "");
+    const char* none[] = {0};
+    request_hdr h;
+    TEST_ASSERT(h.accept_select(none) == "");
+}
 namespace restcgi_test {
     void hdr_tests(test_utils::test& t) {
         t.add("restcgi hdr insert", test_insert);
         t.add("restcgi hdr cookie", test_cookie);
+        t.add("restcgi hdr accept select", test_accept_select);
     }
 }
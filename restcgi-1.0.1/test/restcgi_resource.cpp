@@ -277,6 +277,58 @@ static void test_version() {
         TEST_ASSERT(oss.str() == "Status: 412 Precondition Failed\r\n\r\n");
     }
 }
+class test3 : public resource {
+public:
+    test3() : resource(method_e::GET | method_e::HEAD), renders(0) {}
+    version read(bool veronly) {return version_tag("\"7\"");}
+    void render() {++renders; body_ = "rendered";}
+    void on_responding(status_code_e& sc, response_hdr& rh, content_hdr& ch) {
+        ch.content_type("text/plain");
+        if (me() != method_e::HEAD)
+            ch.content_length(body_.size());
+    }
+    void write(ocontent::pointer oc) {
+        *oc << body_;
+    }
+    int renders;
+    std::string body_;
+};
+static void test_render() {
+    {
+        const char* p[] = {"REQUEST_METHOD=GET","PATH_INFO=","SCRIPT_URI=http://woo.com/cgi-bin/my.exe",0};
+        env e(p);
+        istringstream iss;
+        ostringstream oss;
+        endpoint::method_pointer m = endpoint::create(e, iss, oss)->receive();
+        test3* t = new test3();
+        resource::pointer r(t);
+        rest().process(m, r);
+        TEST_ASSERT(t->renders == 1);
+        TEST_ASSERT(oss.str() == "Status: 200 OK\r\nETag: \"7\"\r\nContent-Length: 8\r\nContent-Type: text/plain\r\n\r\nrendered");
+    } {
+        const char* p[] = {"REQUEST_METHOD=HEAD","PATH_INFO=","SCRIPT_URI=http://woo.com/cgi-bin/my.exe",0};
+        env e(p);
+        istringstream iss;
+        ostringstream oss;
+        endpoint::method_pointer m = endpoint::create(e, iss, oss)->receive();
+        test3* t = new test3();
+        resource::pointer r(t);
+        rest().process(m, r);
+        TEST_ASSERT(t->renders == 0);
+        TEST_ASSERT(oss.str() == "Status: 200 OK\r\nETag: \"7\"\r\nContent-Type: text/plain\r\n\r\n");
+    } {
+        const char* p[] = {"REQUEST_METHOD=GET","PATH_INFO=","SCRIPT_URI=http://woo.com/cgi-bin/my.exe","HTTP_IF_NONE_MATCH=\"7\"",0};
+        env e(p);
+        istringstream iss;
+        ostringstream oss;
+        endpoint::method_pointer m = endpoint::create(e, iss, oss)->receive();
+        test3* t = new test3();
+        resource::pointer r(t);
+        rest().process(m, r);
+        TEST_ASSERT(t->renders == 0);
+        TEST_ASSERT(oss.str().find("Status: 304 Not Modified\r\n") == 0);
+    }
+}
 namespace restcgi_test {
     void resource_tests(test_utils::test& t) {
         t.add("restcgi resource locate", test_locate);
@@ -285,5 +337,6 @@ namespace restcgi_test {
         t.add("restcgi resource options", test_options);
         t.add("restcgi resource rest", test_rest);
         t.add("restcgi resource version", test_version);
+        t.add("restcgi resource render", test_render);
     }
 }
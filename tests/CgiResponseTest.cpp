@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "../CgiResponse.h"
+
+using namespace std;
+
+TEST(CgiResponseTest, splitsHeadersAndBody) {
+
+	CgiResponse rsp = CgiResponse::parse("Status: 404 Not Found\r\nETag: \"1\"\r\nContent-Type: application/json\r\n\r\n{\"a\":1}");
+	ASSERT_EQ(404, rsp.status);
+	ASSERT_EQ("\"1\"", rsp.etag);
+	ASSERT_EQ("application/json", rsp.contentType);
+	ASSERT_EQ("{\"a\":1}", rsp.body);
+
+	rsp = CgiResponse::parse("Content-Type: text/plain\r\n\r\n");
+	ASSERT_EQ(200, rsp.status);
+	ASSERT_EQ("", rsp.body);
+}
+
+TEST(CgiResponseTest, survivesTruncatedOutput) {
+
+	ASSERT_EQ(200, CgiResponse::parse("").status);
+	ASSERT_EQ(204, CgiResponse::parse("Status: 204 No Content").status);
+
+	CgiResponse rsp = CgiResponse::parse("Status: 500\r\nETag:\r\nX-Empty: \r\nContent-Type: text/plain");
+	ASSERT_EQ(500, rsp.status);
+	ASSERT_EQ("", rsp.etag);
+	ASSERT_EQ("text/plain", rsp.contentType);
+	ASSERT_EQ("", rsp.body);
+}
+
+TEST(CgiResponseTest, embedsBodiesByType) {
+
+	CgiResponse rsp;
+	rsp.etag = "\"7\"";
+	rsp.contentType = "application/json";
+	rsp.body = "{\"a\":1}";
+	string out;
+	rsp.appendJson(out, "/");
+	ASSERT_EQ("{\"path\": \"/\", \"status\": 200, \"etag\": \"\\\"7\\\"\", \"body\": {\"a\":1}}", out);
+
+	rsp.etag.clear();
+	rsp.contentType = "text/plain; version=0.0.4";
+	rsp.body = "a\n";
+	out.clear();
+	rsp.appendJson(out, "/metrics");
+	ASSERT_EQ("{\"path\": \"/metrics\", \"status\": 200, \"body\": \"a\\n\"}", out);
+
+	rsp.contentType = "application/x-cereal-portable-binary";
+	rsp.body = string("\x01\xff\0", 3);
+	out.clear();
+	rsp.appendJson(out, "/");
+	ASSERT_EQ("{\"path\": \"/\", \"status\": 200, \"bodyBase64\": \"Af8A\"}", out);
+
+	out.clear();
+	CgiResponse::appendBase64(out, "ab");
+	CgiResponse::appendBase64(out, "a");
+	ASSERT_EQ("YWI=YQ==", out);
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include "../CircuitBreaker.h"
+
+using namespace std;
+
+typedef CircuitBreaker::clock clock_type;
+
+TEST(CircuitBreakerTest, opensAfterConsecutiveFailures) {
+
+	CircuitBreaker breaker(3, chrono::seconds(5));
+	clock_type::time_point now = clock_type::now();
+
+	breaker.failure(now);
+	breaker.failure(now);
+	ASSERT_TRUE(breaker.allow(now));
+	breaker.success(); // resets the count
+	breaker.failure(now);
+	breaker.failure(now);
+	ASSERT_EQ(CircuitBreaker::CLOSED, breaker.state());
+
+	breaker.failure(now);
+	ASSERT_EQ(CircuitBreaker::OPEN, breaker.state());
+	ASSERT_FALSE(breaker.allow(now + chrono::seconds(4)));
+}
+
+TEST(CircuitBreakerTest, halfOpenLetsOneProbeThrough) {
+
+	CircuitBreaker breaker(1, chrono::seconds(5));
+	clock_type::time_point now = clock_type::now();
+	breaker.failure(now);
+
+	ASSERT_TRUE(breaker.allow(now + chrono::seconds(5)));
+	ASSERT_EQ(CircuitBreaker::HALF_OPEN, breaker.state());
+	ASSERT_FALSE(breaker.allow(now + chrono::seconds(5)));
+
+	breaker.success();
+	ASSERT_EQ(CircuitBreaker::CLOSED, breaker.state());
+	ASSERT_TRUE(breaker.allow(now + chrono::seconds(5)));
+}
+
+TEST(CircuitBreakerTest, failedProbeReopens) {
+
+	CircuitBreaker breaker(3, chrono::seconds(5));
+	clock_type::time_point now = clock_type::now();
+	for (int i = 0; i < 3; ++i)
+		breaker.failure(now);
+
+	clock_type::time_point later = now + chrono::seconds(6);
+	ASSERT_TRUE(breaker.allow(later));
+	breaker.failure(later); // a single failure is enough when half-open
+
+	ASSERT_EQ(CircuitBreaker::OPEN, breaker.state());
+	ASSERT_FALSE(breaker.allow(later + chrono::seconds(4)));
+	ASSERT_TRUE(breaker.allow(later + chrono::seconds(5)));
+}
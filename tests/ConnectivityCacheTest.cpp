@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "../ConnectivityCache.h"
+
+using namespace std;
+
+TEST(ConnectivityCacheTest, emptyUntilFirstCheck) {
+
+	ConnectivityCache cache([] { return uint32_t(ConnectivityCache::FULL); });
+
+	ASSERT_EQ(0, cache.get(1000).checked);
+	ASSERT_TRUE(cache.refresh(1000));
+
+	ConnectivityCache::Result r = cache.get(1010);
+	ASSERT_EQ(uint32_t(ConnectivityCache::FULL), r.state);
+	ASSERT_EQ(1000, r.checked);
+	ASSERT_STREQ("full", ConnectivityCache::name(r.state));
+}
+
+TEST(ConnectivityCacheTest, failedCheckKeepsLastResult) {
+
+	bool fail = false;
+	ConnectivityCache cache([&] {
+		if (fail)
+			throw runtime_error("timeout");
+		return uint32_t(ConnectivityCache::PORTAL);
+	});
+	cache.refresh(1000);
+
+	fail = true;
+	ASSERT_FALSE(cache.refresh(1100));
+	ASSERT_EQ(1000, cache.get(1100).checked);
+	ASSERT_EQ(uint32_t(ConnectivityCache::PORTAL), cache.get(1100).state);
+}
+
+TEST(ConnectivityCacheTest, staleReadsShareOneBackgroundCheck) {
+
+	mutex m;
+	condition_variable done;
+	int checks = 0;
+	ConnectivityCache cache([&] {
+		lock_guard<mutex> lock(m);
+		++checks;
+		done.notify_all();
+		return uint32_t(ConnectivityCache::LIMITED);
+	}, chrono::seconds(30));
+	cache.refresh(1000);
+	checks = 0;
+	cache.start();
+
+	cache.get(1010); // fresh: nothing to do
+	for (int i = 0; i < 100; ++i)
+		cache.get(1031);
+	{
+		unique_lock<mutex> lock(m);
+		ASSERT_TRUE(done.wait_for(lock, chrono::seconds(5), [&] { return checks > 0; }));
+	}
+	cache.stop();
+
+	ASSERT_EQ(1, checks);
+	ASSERT_NE(1000, cache.get(1031).checked);
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include "../DeviceTable.h"
+
+using namespace std;
+
+static DeviceTable::map_type makeDevices(int n) {
+	DeviceTable::map_type devices;
+	for (int i = 0; i < n; ++i) {
+		shared_ptr<DeviceInfo> device(new DeviceInfo());
+		device->interface = "eth" + to_string(i);
+		device->path = "/org/freedesktop/NetworkManager/Devices/" + to_string(i);
+		devices[device->interface] = device;
+	}
+	return devices;
+}
+
+TEST(DeviceTableTest, pagesCoverEveryDeviceOnce) {
+
+	DeviceTable table(makeDevices(25), 1, 1000);
+
+	size_t seen = 0, pages = 0;
+	string cursor, next;
+	do {
+		vector<const DeviceInfo *> page = table.page(cursor, 10, next);
+		ASSERT_LE(page.size(), 10u);
+		if (!next.empty()) {
+			ASSERT_EQ(next, page.back()->interface);
+		}
+		seen += page.size();
+		++pages;
+		cursor = next;
+	} while (!next.empty());
+
+	ASSERT_EQ(25u, seen);
+	ASSERT_EQ(3u, pages);
+}
+
+TEST(DeviceTableTest, cursorSurvivesRemovalOfItsDevice) {
+
+	DeviceTable::map_type devices = makeDevices(5); // eth0..eth4
+	string next;
+	DeviceTable(devices, 1, 1000).page("", 2, next);
+	ASSERT_EQ("eth1", next);
+
+	devices.erase("eth1");
+	vector<const DeviceInfo *> page = DeviceTable(devices, 2, 1000).page(next, 2, next);
+	ASSERT_EQ(2u, page.size());
+	ASSERT_EQ("eth2", page[0]->interface);
+	ASSERT_EQ("eth3", page[1]->interface);
+	ASSERT_EQ("eth3", next);
+}
+
+TEST(DeviceTableTest, lastPageHasNoCursor) {
+
+	DeviceTable table(makeDevices(4), 1, 1000);
+	string next;
+
+	ASSERT_EQ(4u, table.page("", 4, next).size());
+	ASSERT_TRUE(next.empty());
+	ASSERT_TRUE(table.page("eth3", 4, next).empty());
+	ASSERT_TRUE(next.empty());
+}
+
+TEST(DeviceTableTest, deviceEncoding) {
+
+	DeviceInfo device;
+	device.interface = "eth0";
+	device.path = "/org/freedesktop/NetworkManager/Devices/0";
+	device.driver = "e1000e";
+	device.deviceType = 1;
+	device.state = 100;
+	device.mtu = 1500;
+	device.managed = true;
+
+	string out;
+	device.encodeJson(out);
+	ASSERT_EQ("{\"interface\":\"eth0\",\"path\":\"/org/freedesktop/NetworkManager/Devices/0\",\"driver\":\"e1000e\","
+	          "\"deviceType\":1,\"state\":100,\"mtu\":1500,\"managed\":true}", out);
+
+	Ip4Config ip4;
+	IpAddress address;
+	IpAddress::parse("10.0.0.5/24", address);
+	ip4.addresses.push_back(address);
+	IpAddress::parse("10.0.0.1", ip4.gateway);
+	ip4.nameservers.push_back(IpAddress::v4(0x0a0000fe));
+	out.clear();
+	ip4.encodeJson(out);
+	ASSERT_EQ("{\"addresses\":[\"10.0.0.5/24\"],\"gateway\":\"10.0.0.1\",\"nameservers\":[\"10.0.0.254\"]}", out);
+}
+
+TEST(DeviceTableTest, stateOnlyMovesOnChange) {
+
+	DeviceState state;
+	ASSERT_FALSE(DeviceState::Reader(state).table());
+
+	DeviceTable::map_type devices = makeDevices(3);
+	ASSERT_TRUE(state.update(devices, 1000));
+	ASSERT_FALSE(state.update(devices, 2000));
+
+	DeviceState::Reader reader(state);
+	ASSERT_EQ(1u, reader.table()->generation());
+	ASSERT_EQ(1000, reader.table()->modified());
+	ASSERT_TRUE(reader.table()->find("eth2"));
+	ASSERT_FALSE(reader.table()->find("eth3"));
+
+	devices.erase("eth0");
+	ASSERT_TRUE(state.update(devices, 3000));
+	ASSERT_EQ(2u, DeviceState::Reader(state).table()->generation());
+}
+
+TEST(DeviceTableTest, tagFollowsGenerationAndQuery) {
+
+	DeviceTable::map_type devices = makeDevices(3);
+	DeviceTable first(devices, 1, 1000, 7);
+	ASSERT_EQ(first.etag("devices"), DeviceTable(devices, 1, 2000, 7).etag("devices"));
+	ASSERT_NE(first.etag("devices"), first.etag("device\neth0"));
+	ASSERT_NE(first.etag("devices"), DeviceTable(devices, 2, 1000, 7).etag("devices"));
+	// Generation 1 of a restarted process is another table.
+	ASSERT_NE(first.etag("devices"), DeviceTable(devices, 1, 1000, 8).etag("devices"));
+
+	DeviceState follower;
+	ASSERT_TRUE(follower.adopt(devices, 7, 1, 1000));
+	ASSERT_FALSE(follower.adopt(devices, 7, 1, 1000));
+	ASSERT_EQ(first.etag("devices"), DeviceState::Reader(follower).table()->etag("devices"));
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "../EventRing.h"
+
+using namespace std;
+
+TEST(EventRingTest, sinceReturnsNewerEvents) {
+
+	EventRing ring(8);
+	ring.publish("StateChanged", "{\"state\": 70}");
+	ring.publish("DeviceAdded", "{\"device\": \"/org/freedesktop/NetworkManager/Devices/3\"}");
+
+	vector<NetworkEvent> events;
+	ASSERT_TRUE(ring.since(1, events));
+	ASSERT_EQ(1u, events.size());
+	ASSERT_EQ(2u, events[0].id);
+	ASSERT_EQ("DeviceAdded", events[0].type);
+
+	events.clear();
+	ASSERT_TRUE(ring.since(2, events));
+	ASSERT_TRUE(events.empty());
+}
+
+TEST(EventRingTest, overrunIsReported) {
+
+	EventRing ring(2);
+	ring.publish("StateChanged", "1");
+	ring.publish("StateChanged", "2");
+	ring.publish("StateChanged", "3");
+
+	vector<NetworkEvent> events;
+	ASSERT_FALSE(ring.since(0, events));
+	ASSERT_EQ(2u, events.size());
+	ASSERT_EQ(2u, events[0].id);
+
+	events.clear();
+	ASSERT_TRUE(ring.since(1, events));
+	ASSERT_EQ(2u, events.size());
+}
+
+TEST(EventRingTest, unknownIdIsTreatedAsLost) {
+
+	EventRing ring(4);
+	ring.publish("StateChanged", "1");
+
+	vector<NetworkEvent> events;
+	ASSERT_FALSE(ring.since(42, events));
+	ASSERT_EQ(1u, events.size());
+
+	EventRing empty(4);
+	events.clear();
+	ASSERT_FALSE(empty.since(42, events));
+	ASSERT_TRUE(events.empty());
+}
+
+TEST(EventRingTest, waitWakesOnPublishAndClose) {
+
+	EventRing ring(4);
+	ASSERT_FALSE(ring.wait(0, std::chrono::milliseconds(1)));
+
+	thread publisher([&ring] { ring.publish("StateChanged", "1"); });
+	ASSERT_TRUE(ring.wait(0, std::chrono::seconds(5)));
+	publisher.join();
+
+	thread closer([&ring] { ring.close(); });
+	ASSERT_FALSE(ring.wait(1, std::chrono::seconds(5)));
+	closer.join();
+	ASSERT_TRUE(ring.closed());
+}
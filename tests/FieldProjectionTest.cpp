@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include "../NetworkData.h"
+
+using namespace std;
+
+TEST(FieldProjectionTest, parseNormalizes) {
+
+	FieldSet fields = FieldSet::parse(" gateway,netmask , gateway,,");
+
+	ASSERT_EQ("gateway,netmask", fields.key());
+	ASSERT_TRUE(fields.contains("gateway"));
+	ASSERT_TRUE(fields.contains("netmask"));
+	ASSERT_FALSE(fields.contains("ipAddress"));
+	ASSERT_TRUE(FieldSet::parse("").empty());
+}
+
+TEST(FieldProjectionTest, onlyRequestedMembersAreSerialized) {
+
+	NetworkData data("172.17.0.1", "255.0.0.0", "192.168.1.1");
+
+	string json = data.serialize(FieldSet::parse("gateway"));
+
+	ASSERT_NE(string::npos, json.find("\"gateway\":\"192.168.1.1\""));
+	ASSERT_EQ(string::npos, json.find("ipAddress"));
+	ASSERT_EQ(string::npos, json.find("netmask"));
+}
+
+TEST(FieldProjectionTest, plainArchiveSerializesEverything) {
+
+	NetworkData data("172.17.0.1", "255.0.0.0", "192.168.1.1");
+
+	string json = data.serialize();
+
+	ASSERT_NE(string::npos, json.find("ipAddress"));
+	ASSERT_NE(string::npos, json.find("netmask"));
+	ASSERT_NE(string::npos, json.find("gateway"));
+}
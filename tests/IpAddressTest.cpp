@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
+
+#include "../IpAddress.h"
+
+using namespace std;
+
+static IpAddress parsed(const string & text) {
+	IpAddress address = IpAddress();
+	EXPECT_TRUE(IpAddress::parse(text, address)) << text;
+	return address;
+}
+
+TEST(IpAddressTest, parsesAndFormatsV4) {
+
+	IpAddress a = parsed("172.17.0.1");
+
+	ASSERT_EQ(IpAddress::V4, a.family);
+	ASSERT_EQ(32, a.prefix);
+	ASSERT_EQ(0xac110001u, a.word());
+	ASSERT_EQ("172.17.0.1", a.str());
+	ASSERT_EQ(IpAddress::v4(0xac110001u), a);
+	ASSERT_EQ("10.0.0.0/8", parsed("10.0.0.0/8").str(true));
+	ASSERT_EQ("0.0.0.0", parsed("0.0.0.0").str());
+	ASSERT_EQ("255.255.255.255", parsed("255.255.255.255").str());
+}
+
+TEST(IpAddressTest, parsesAndFormatsV6) {
+
+	IpAddress a = parsed("FE80:0:0:0:0:0:0:1/64");
+
+	ASSERT_EQ(IpAddress::V6, a.family);
+	ASSERT_EQ(64, a.prefix);
+	ASSERT_EQ("fe80::1/64", a.str(true));
+	ASSERT_EQ("::ffff:172.17.0.1", parsed("::ffff:172.17.0.1").str());
+	ASSERT_EQ("::", parsed("::").str());
+}
+
+TEST(IpAddressTest, rejectsMalformedText) {
+
+	const char * bad[] = { "1.2.3", "1.2.3.4.5", "1.2.3.256", "1.2.3.4/33", "1.2.3.4/", "1..2.3",
+	                       "01234.1.1.1", "fe80::1::2", "fe80::1/129", "1.2.3.4 ", "host" };
+	for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+		IpAddress a = IpAddress::v4(1);
+		ASSERT_FALSE(IpAddress::parse(bad[i], a)) << bad[i];
+		ASSERT_EQ(IpAddress::v4(1), a);
+	}
+
+	IpAddress empty = IpAddress::v4(1);
+	ASSERT_TRUE(IpAddress::parse("", empty));
+	ASSERT_TRUE(empty.empty());
+	ASSERT_EQ("", empty.str());
+}
+
+TEST(IpAddressTest, masks) {
+
+	ASSERT_EQ(24, parsed("255.255.255.0").maskLength());
+	ASSERT_EQ(0, parsed("0.0.0.0").maskLength());
+	ASSERT_EQ(-1, parsed("255.0.255.0").maskLength());
+	ASSERT_EQ("255.255.240.0", parsed("10.0.0.0/20").mask().str());
+	ASSERT_EQ("ffff:ffff:ffff:ffff::", parsed("fe80::/64").mask().str());
+	ASSERT_EQ(64, parsed("ffff:ffff:ffff:ffff::").maskLength());
+}
+
+TEST(IpAddressTest, cerealArchives) {
+
+	IpAddress a = parsed("fe80::1/64");
+	IpAddress b = IpAddress();
+	std::stringstream ss;
+	{
+		cereal::PortableBinaryOutputArchive archive(ss);
+		archive(a);
+	}
+	{
+		cereal::PortableBinaryInputArchive archive(ss);
+		archive(b);
+	}
+	ASSERT_EQ(a, b);
+
+	std::stringstream json;
+	{
+		cereal::JSONOutputArchive archive(json);
+		archive(cereal::make_nvp("gateway", parsed("192.168.1.1")));
+	}
+	ASSERT_NE(string::npos, json.str().find("\"gateway\": \"192.168.1.1\""));
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include "../JobTable.h"
+
+using namespace std;
+
+static const string ACTIVE = "/org/freedesktop/NetworkManager/ActiveConnection/7";
+
+TEST(JobTableTest, activationFollowsStateSignals) {
+
+	JobTable jobs;
+	uint64_t id = jobs.create("activate", "", 1000);
+	Job job;
+
+	ASSERT_TRUE(jobs.find(id, job));
+	ASSERT_EQ("queued", job.state);
+
+	jobs.activeState(ACTIVE, JobTable::ACTIVATED); // not ours yet
+	jobs.running(id);
+	jobs.started(id, ACTIVE, 1001);
+	jobs.find(id, job);
+	ASSERT_EQ("activating", job.state);
+	ASSERT_EQ(ACTIVE, job.activeConnection);
+	ASSERT_TRUE(jobs.watched(ACTIVE));
+
+	jobs.activeState(ACTIVE, JobTable::ACTIVATED, 0, 1002);
+	jobs.find(id, job);
+	ASSERT_EQ("activated", job.state);
+	ASSERT_TRUE(job.done);
+	ASSERT_EQ(1002, job.updated);
+	ASSERT_FALSE(jobs.watched(ACTIVE));
+
+	jobs.activeState(ACTIVE, JobTable::DEACTIVATED); // finished jobs stay put
+	jobs.find(id, job);
+	ASSERT_EQ("activated", job.state);
+}
+
+TEST(JobTableTest, deactivatedBeforeActivatedFails) {
+
+	JobTable jobs;
+	uint64_t id = jobs.create("activate");
+	jobs.running(id);
+	jobs.started(id, ACTIVE);
+
+	jobs.activeState(ACTIVE, JobTable::DEACTIVATED, 5);
+	Job job;
+	jobs.find(id, job);
+	ASSERT_EQ("failed", job.state);
+	ASSERT_EQ("activation failed, reason 5", job.error);
+	ASSERT_TRUE(job.done);
+}
+
+TEST(JobTableTest, deactivationWaitsForDeactivated) {
+
+	JobTable jobs;
+	uint64_t id = jobs.create("deactivate", ACTIVE);
+	jobs.running(id);
+	jobs.started(id, ACTIVE);
+
+	jobs.activeState(ACTIVE, JobTable::ACTIVATED);
+	Job job;
+	jobs.find(id, job);
+	ASSERT_EQ("deactivating", job.state);
+
+	jobs.activeState(ACTIVE, JobTable::DEACTIVATED);
+	jobs.find(id, job);
+	ASSERT_EQ("deactivated", job.state);
+	ASSERT_TRUE(job.done);
+}
+
+TEST(JobTableTest, callFailureEndsJob) {
+
+	JobTable jobs;
+	uint64_t id = jobs.create("activate");
+	jobs.running(id);
+	jobs.failed(id, "No suitable device found");
+
+	Job job;
+	jobs.find(id, job);
+	ASSERT_EQ("failed", job.state);
+	ASSERT_EQ("No suitable device found", job.error);
+
+	string out;
+	job.encodeJson(out);
+	ASSERT_NE(string::npos, out.find("\"done\":true"));
+}
+
+TEST(JobTableTest, oldestJobsAreDropped) {
+
+	JobTable jobs;
+	uint64_t first = jobs.create("activate");
+	for (int i = 0; i < JobTable::MAX_JOBS; ++i)
+		jobs.create("activate");
+
+	Job job;
+	ASSERT_FALSE(jobs.find(first, job));
+	ASSERT_TRUE(jobs.find(first + 1, job));
+	ASSERT_FALSE(jobs.find(first + JobTable::MAX_JOBS + 1, job));
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include "../JsonEncoder.h"
+
+using namespace std;
+
+namespace {
+
+struct Inner {
+	string name;
+	bool up;
+
+#define INNER_FIELDS(FIELD) FIELD(name) FIELD(up)
+	void encodeJson(string & out, const FieldSet * fields = 0) const
+	{
+		jsonObject(out, fields INNER_FIELDS(JSON_FIELD));
+	}
+};
+
+struct Outer {
+	int metric;
+	unsigned long long bytes;
+	vector<Inner> devices;
+	const char * state;
+
+#define OUTER_FIELDS(FIELD) FIELD(metric) FIELD(bytes) FIELD(devices) FIELD(state)
+	void encodeJson(string & out, const FieldSet * fields = 0) const
+	{
+		jsonObject(out, fields OUTER_FIELDS(JSON_FIELD));
+	}
+};
+
+}
+
+TEST(JsonEncoderTest, encodesMemberList) {
+
+	Outer outer = { -42, 18446744073709551615ULL, { { "eth0", true }, { "wl\"an", false } }, "up" };
+	string out;
+	outer.encodeJson(out);
+
+	ASSERT_EQ("{\"metric\":-42,\"bytes\":18446744073709551615,"
+	          "\"devices\":[{\"name\":\"eth0\",\"up\":true},{\"name\":\"wl\\\"an\",\"up\":false}],"
+	          "\"state\":\"up\"}", out);
+}
+
+TEST(JsonEncoderTest, projectionKeepsSeparatorsValid) {
+
+	Outer outer = { 0, 7, {}, "down" };
+	FieldSet fields = FieldSet::parse("state,bytes");
+	string out;
+	outer.encodeJson(out, &fields);
+
+	ASSERT_EQ("{\"bytes\":7,\"state\":\"down\"}", out);
+
+	FieldSet none = FieldSet::parse("nothing");
+	out.clear();
+	outer.encodeJson(out, &none);
+	ASSERT_EQ("{}", out);
+}
+
+TEST(JsonEncoderTest, fieldSetMatchesUnterminatedNames) {
+
+	FieldSet fields = FieldSet::parse("gate");
+
+	ASSERT_TRUE(fields.contains("gateway", 4));
+	ASSERT_FALSE(fields.contains("gateway", 7));
+	ASSERT_FALSE(fields.contains("gat", 3));
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+
+#include "../Metrics.h"
+
+using namespace std;
+
+TEST(MetricsTest, bucketsHoldTheirUpperBound) {
+
+	ASSERT_EQ(0u, LatencyBuckets::index(0));
+	ASSERT_EQ(0u, LatencyBuckets::index(16));
+	ASSERT_EQ(1u, LatencyBuckets::index(17));
+	ASSERT_EQ(16u, LatencyBuckets::upper(0));
+	ASSERT_EQ(24u, LatencyBuckets::upper(1));
+	ASSERT_EQ(32u, LatencyBuckets::upper(2));
+	ASSERT_EQ(48u, LatencyBuckets::upper(3));
+	for (unsigned i = 0; i + 1 < LatencyBuckets::COUNT; ++i) {
+		ASSERT_EQ(i, LatencyBuckets::index(LatencyBuckets::upper(i)));
+		ASSERT_EQ(i + 1, LatencyBuckets::index(LatencyBuckets::upper(i) + 1));
+	}
+	ASSERT_EQ(LatencyBuckets::COUNT - 1u, LatencyBuckets::index(UINT64_MAX));
+}
+
+TEST(MetricsTest, routesByFirstSegment) {
+
+	ASSERT_EQ(Metrics::ROOT, Metrics::route(""));
+	ASSERT_EQ(Metrics::DEVICES, Metrics::route("devices"));
+	ASSERT_EQ(Metrics::OTHER, Metrics::route("nosuch"));
+}
+
+TEST(MetricsTest, threadsAreMergedAtScrape) {
+
+	Metrics metrics;
+	vector<thread> threads;
+	for (int t = 0; t < 4; ++t)
+		threads.push_back(thread([&metrics] {
+			for (int i = 0; i < 1000; ++i) {
+				metrics.started(Metrics::DEVICES);
+				metrics.finished(Metrics::DEVICES, i % 10 ? 200 : 404, chrono::microseconds(100));
+			}
+		}));
+	for (size_t t = 0; t < threads.size(); ++t)
+		threads[t].join();
+	metrics.started(Metrics::EVENTS);
+
+	string text = metrics.render();
+	ASSERT_NE(string::npos, text.find("fcgiapp_requests_total{route=\"devices\",status=\"200\"} 3600\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_requests_total{route=\"devices\",status=\"404\"} 400\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_requests_in_flight{route=\"devices\"} 0\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_requests_in_flight{route=\"events\"} 1\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_request_duration_seconds_bucket{route=\"devices\",le=\"6.4e-05\"} 0\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_request_duration_seconds_bucket{route=\"devices\",le=\"0.000128\"} 4000\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_request_duration_seconds_bucket{route=\"devices\",le=\"+Inf\"} 4000\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_request_duration_seconds_sum{route=\"devices\"} 0.400000\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_request_duration_seconds_count{route=\"devices\"} 4000\n"));
+	ASSERT_EQ(string::npos, text.find("route=\"jobs\""));
+}
+
+TEST(MetricsTest, dbusTimerCountsFailures) {
+
+	Metrics metrics;
+	{
+		Metrics::DBusTimer timer(Metrics::GET_DEVICES, metrics);
+	}
+	try {
+		Metrics::DBusTimer timer(Metrics::GET_DEVICES, metrics);
+		throw runtime_error("timeout");
+	} catch (const runtime_error &) {
+	}
+	metrics.cache(Metrics::DEVICE_CACHE, true);
+	metrics.cache(Metrics::DEVICE_CACHE, true);
+	metrics.cache(Metrics::DEVICE_CACHE, false);
+
+	string text = metrics.render();
+	ASSERT_NE(string::npos, text.find("fcgiapp_dbus_calls_total{call=\"GetDevices\",result=\"ok\"} 1\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_dbus_calls_total{call=\"GetDevices\",result=\"error\"} 1\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_dbus_calls_in_flight{call=\"GetDevices\"} 0\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_dbus_call_duration_seconds_count{call=\"GetDevices\"} 2\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_cache_lookups_total{cache=\"devices\",result=\"hit\"} 2\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_cache_lookups_total{cache=\"devices\",result=\"miss\"} 1\n"));
+}
+
+TEST(MetricsTest, workerLabelsEverySeries) {
+
+	Metrics metrics("3");
+	metrics.started(Metrics::DEVICES);
+	metrics.finished(Metrics::DEVICES, 200, chrono::microseconds(100));
+
+	string text = metrics.render();
+	ASSERT_NE(string::npos, text.find("fcgiapp_requests_total{worker=\"3\",route=\"devices\",status=\"200\"} 1\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_requests_in_flight{worker=\"3\",route=\"devices\"} 0\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_request_duration_seconds_bucket{worker=\"3\",route=\"devices\",le=\"+Inf\"} 1\n"));
+	ASSERT_NE(string::npos, text.find("fcgiapp_request_duration_seconds_count{worker=\"3\",route=\"devices\"} 1\n"));
+}
+
+TEST(MetricsTest, inFlightNeverWrapsWhileScraped) {
+
+	Metrics metrics;
+	atomic<bool> done(false);
+	thread worker([&metrics, &done] {
+		while (!done) {
+			metrics.started(Metrics::DEVICES);
+			metrics.finished(Metrics::DEVICES, 200, chrono::microseconds(100));
+		}
+	});
+	const string gauge = "fcgiapp_requests_in_flight{route=\"devices\"} ";
+	for (int i = 0; i < 2000; ++i) {
+		string text = metrics.render();
+		size_t pos = text.find(gauge);
+		if (pos != string::npos) {
+			ASSERT_LE(strtoull(text.c_str() + pos + gauge.size(), 0, 10), 1u);
+		}
+	}
+	done = true;
+	worker.join();
+}
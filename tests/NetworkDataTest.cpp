@@ -16,4 +16,76 @@ TEST(NetworkDataTest, serialization) {
 	ASSERT_NE(string::npos, data->serialize().find(mask));
 	ASSERT_NE(string::npos, data->serialize().find(gateway));
      
-}
\ No newline at end of file
+}
+
+TEST(NetworkDataTest, compactDocument) {
+
+	NetworkData data("172.17.0.1", "255.0.0.0", "192.168.1.1");
+	string expected("{\"value0\":{\"ipAddress\":\"172.17.0.1\",\"netmask\":\"255.0.0.0\",\"gateway\":\"192.168.1.1\"}}");
+
+	ASSERT_EQ(expected, data.serialize());
+	// The thread's buffer is reused; a second document must not carry the first.
+	ASSERT_EQ(expected, data.serialize());
+	const string & buffer = data.encode();
+	ASSERT_EQ(expected, buffer);
+	NetworkData("10.0.0.1", "255.0.0.0", "10.0.0.254").encode();
+	ASSERT_EQ(&buffer, &data.encode());
+}
+
+TEST(NetworkDataTest, rejectsInvalidAddresses) {
+
+	ASSERT_THROW(NetworkData("a\"b", "255.0.0.0", "192.168.1.1"), std::invalid_argument);
+	ASSERT_THROW(NetworkData("172.17.0.1", "255.0.255.0", "192.168.1.1"), std::invalid_argument);
+	ASSERT_THROW(NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.256"), std::invalid_argument);
+}
+
+TEST(NetworkDataTest, compactRecord) {
+
+	NetworkData data("172.17.0.1", "255.255.240.0", "fe80::1");
+
+	ASSERT_EQ(20, data.getIPAddress().prefix);
+	ASSERT_EQ("172.17.0.1/20", data.getIPAddress().str(true));
+	ASSERT_EQ(IpAddress::V6, data.getGateWay().family);
+	ASSERT_EQ("{\"value0\":{\"ipAddress\":\"172.17.0.1\",\"netmask\":\"255.255.240.0\",\"gateway\":\"fe80::1\"}}", data.serialize());
+	ASSERT_LE(sizeof(NetworkData), 3 * sizeof(IpAddress));
+}
+
+TEST(NetworkDataTest, portableBinaryRoundTrip) {
+
+	NetworkData data("172.17.0.1", "255.0.0.0", "192.168.1.1");
+	std::istringstream is(data.serializePortableBinary());
+	NetworkData decoded("", "", "");
+	{
+		cereal::PortableBinaryInputArchive archive(is);
+		archive(decoded);
+	}
+
+	ASSERT_EQ(data.serialize(), decoded.serialize());
+}
+
+TEST(NetworkDataTest, portableBinaryProjection) {
+
+	NetworkData data("172.17.0.1", "255.0.0.0", "192.168.1.1");
+	FieldSet fields = FieldSet::parse("gateway");
+	std::istringstream is(data.serializePortableBinary(&fields));
+	NetworkData decoded("", "", "");
+	{
+		ProjectingArchive<cereal::PortableBinaryInputArchive> archive(fields, is);
+		archive(decoded);
+	}
+
+	ASSERT_EQ("{\"value0\":{\"ipAddress\":\"\",\"netmask\":\"\",\"gateway\":\"192.168.1.1\"}}", decoded.serialize());
+	ASSERT_LT(data.serializePortableBinary(&fields).size(), data.serializePortableBinary().size());
+}
+
+TEST(NetworkDataTest, diffIsJsonPatch) {
+
+	NetworkData from("172.17.0.1", "255.0.0.0", "192.168.1.1");
+	NetworkData to("172.17.0.2", "255.0.0.0", "");
+
+	ASSERT_EQ("[{\"op\":\"replace\",\"path\":\"/value0/ipAddress\",\"value\":\"172.17.0.2\"},"
+	          "{\"op\":\"replace\",\"path\":\"/value0/gateway\",\"value\":\"\"}]", to.diff(from));
+	FieldSet fields = FieldSet::parse("gateway");
+	ASSERT_EQ("[{\"op\":\"replace\",\"path\":\"/value0/gateway\",\"value\":\"\"}]", to.diff(from, &fields));
+	ASSERT_EQ("[]", to.diff(to));
+}
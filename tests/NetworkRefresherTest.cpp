@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "../NetworkRefresher.h"
+
+using namespace std;
+
+typedef NetworkRefresher::clock clock_type;
+
+TEST(NetworkRefresherTest, freshAfterSuccessfulRefresh) {
+
+	NetworkState state;
+	CircuitBreaker breaker;
+	NetworkRefresher refresher(state, [] { return NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1"); }, breaker);
+
+	ASSERT_TRUE(refresher.freshness().stale);
+	ASSERT_EQ(-1, refresher.freshness().age);
+
+	clock_type::time_point now = clock_type::now();
+	ASSERT_TRUE(refresher.refresh(now));
+	ASSERT_TRUE(state.snapshot());
+
+	NetworkRefresher::Freshness f = refresher.freshness(now + chrono::seconds(2));
+	ASSERT_FALSE(f.stale);
+	ASSERT_FALSE(f.failed);
+	ASSERT_EQ(2, f.age);
+
+	ASSERT_TRUE(refresher.freshness(now + chrono::seconds(11)).stale);
+}
+
+TEST(NetworkRefresherTest, failuresKeepLastGoodSnapshot) {
+
+	NetworkState state;
+	CircuitBreaker breaker(2, chrono::seconds(5));
+	int calls = 0;
+	bool fail = false;
+	NetworkRefresher refresher(state, [&] {
+		++calls;
+		if (fail)
+			throw runtime_error("timeout");
+		return NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1");
+	}, breaker);
+
+	clock_type::time_point now = clock_type::now();
+	refresher.refresh(now);
+	NetworkState::snapshot_pointer good = state.snapshot();
+
+	fail = true;
+	ASSERT_FALSE(refresher.refresh(now + chrono::seconds(1)));
+	ASSERT_FALSE(refresher.refresh(now + chrono::seconds(2)));
+	ASSERT_EQ(CircuitBreaker::OPEN, breaker.state());
+	ASSERT_FALSE(refresher.refresh(now + chrono::seconds(3))); // short-circuited
+	ASSERT_EQ(3, calls);
+
+	ASSERT_EQ(good, state.snapshot());
+	NetworkRefresher::Freshness f = refresher.freshness(now + chrono::seconds(3));
+	ASSERT_TRUE(f.stale);
+	ASSERT_TRUE(f.failed);
+	ASSERT_EQ(3, f.age);
+
+	fail = false;
+	ASSERT_TRUE(refresher.refresh(now + chrono::seconds(8))); // probe
+	ASSERT_FALSE(refresher.freshness(now + chrono::seconds(8)).stale);
+}
+
+TEST(NetworkRefresherTest, touchRefreshesInBackground) {
+
+	NetworkState state;
+	CircuitBreaker breaker;
+	mutex m;
+	condition_variable done;
+	int calls = 0;
+	NetworkRefresher refresher(state, [&] {
+		lock_guard<mutex> lock(m);
+		++calls;
+		done.notify_all();
+		return NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1");
+	}, breaker, chrono::milliseconds(0));
+	refresher.start();
+
+	refresher.touch();
+	{
+		unique_lock<mutex> lock(m);
+		ASSERT_TRUE(done.wait_for(lock, chrono::seconds(5), [&] { return calls > 0; }));
+	}
+	refresher.stop();
+
+	ASSERT_TRUE(state.snapshot());
+}
+
+TEST(NetworkRefresherTest, refreshesWhileIdle) {
+
+	NetworkState state;
+	CircuitBreaker breaker;
+	mutex m;
+	condition_variable done;
+	int calls = 0;
+	NetworkRefresher refresher(state, [&] {
+		lock_guard<mutex> lock(m);
+		++calls;
+		done.notify_all();
+		return NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1");
+	}, breaker, chrono::seconds(1), chrono::milliseconds(100));
+	refresher.refresh();
+	refresher.start();
+
+	// No touch(), no invalidate(): the thread keeps it confirmed on its own.
+	{
+		unique_lock<mutex> lock(m);
+		ASSERT_TRUE(done.wait_for(lock, chrono::seconds(5), [&] { return calls >= 4; }));
+	}
+	refresher.stop();
+}
+
+TEST(NetworkRefresherTest, invalidateIgnoresInterval) {
+
+	NetworkState state;
+	CircuitBreaker breaker;
+	mutex m;
+	condition_variable done;
+	int calls = 0;
+	NetworkRefresher refresher(state, [&] {
+		lock_guard<mutex> lock(m);
+		++calls;
+		done.notify_all();
+		return NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1");
+	}, breaker, chrono::hours(1));
+	refresher.refresh();
+	refresher.start();
+
+	refresher.touch(); // within the interval, nothing to do
+	refresher.invalidate();
+	{
+		unique_lock<mutex> lock(m);
+		ASSERT_TRUE(done.wait_for(lock, chrono::seconds(5), [&] { return calls == 2; }));
+	}
+	refresher.stop();
+}
+
+TEST(NetworkRefresherTest, invalidateDuringFetchRefreshesAgain) {
+
+	NetworkState state;
+	CircuitBreaker breaker;
+	mutex m;
+	condition_variable changed;
+	int calls = 0;
+	bool release = false;
+	string address = "172.17.0.1";
+	NetworkRefresher refresher(state, [&] {
+		unique_lock<mutex> lock(m);
+		++calls;
+		changed.notify_all();
+		string read = address; // the D-Bus reply, before the change below
+		while (calls == 1 && !release)
+			changed.wait_for(lock, chrono::milliseconds(10));
+		return NetworkData(read, "255.0.0.0", "192.168.1.1");
+	}, breaker, chrono::hours(1));
+	refresher.start();
+
+	refresher.invalidate();
+	{
+		unique_lock<mutex> lock(m);
+		ASSERT_TRUE(changed.wait_for(lock, chrono::seconds(5), [&] { return calls == 1; }));
+		address = "172.17.0.2"; // changes while the first fetch is out
+	}
+	refresher.invalidate();
+	{
+		unique_lock<mutex> lock(m);
+		release = true;
+		changed.notify_all();
+		ASSERT_TRUE(changed.wait_for(lock, chrono::seconds(5), [&] { return calls == 2; }));
+	}
+	refresher.stop();
+	ASSERT_EQ("172.17.0.2", state.snapshot()->data().getIPAddress().str());
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include "../NetworkState.h"
+
+using namespace std;
+
+TEST(NetworkStateTest, emptyUntilFirstUpdate) {
+
+	NetworkState state;
+
+	ASSERT_FALSE(state.snapshot());
+}
+
+TEST(NetworkStateTest, unchangedDataKeepsGeneration) {
+
+	NetworkState state;
+
+	ASSERT_TRUE(state.update(NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1"), 1000));
+	NetworkState::snapshot_pointer first = state.snapshot();
+
+	ASSERT_FALSE(state.update(NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1"), 2000));
+	NetworkState::snapshot_pointer second = state.snapshot();
+
+	ASSERT_EQ(first, second);
+	ASSERT_EQ(1u, second->generation());
+	ASSERT_EQ(1000, second->modified());
+}
+
+TEST(NetworkStateTest, changedDataBumpsGenerationAndETag) {
+
+	NetworkState state;
+
+	state.update(NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1"), 1000);
+	NetworkState::snapshot_pointer first = state.snapshot();
+
+	ASSERT_TRUE(state.update(NetworkData("172.17.0.2", "255.0.0.0", "192.168.1.1"), 2000));
+	NetworkState::snapshot_pointer second = state.snapshot();
+
+	ASSERT_EQ(2u, second->generation());
+	ASSERT_EQ(2000, second->modified());
+	ASSERT_NE(first->etag(), second->etag());
+	ASSERT_NE(string::npos, second->body().find("172.17.0.2"));
+}
+
+TEST(NetworkStateTest, etagIsQuotedContentHash) {
+
+	NetworkState state;
+	state.update(NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1"));
+	NetworkState::snapshot_pointer snapshot = state.snapshot();
+
+	ASSERT_EQ(18u, snapshot->etag().size());
+	ASSERT_EQ('"', snapshot->etag()[0]);
+	ASSERT_EQ('"', snapshot->etag()[17]);
+	ASSERT_EQ(strongETag(snapshot->body()), snapshot->etag());
+}
+
+TEST(NetworkStateTest, historyKeepsRecentGenerations) {
+
+	NetworkState state(2);
+	state.update(NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1"), 1000);
+	state.update(NetworkData("172.17.0.2", "255.0.0.0", "192.168.1.1"), 2000);
+	state.update(NetworkData("172.17.0.3", "255.0.0.0", "192.168.1.1"), 3000);
+
+	ASSERT_FALSE(state.snapshot(0));
+	ASSERT_FALSE(state.snapshot(1));
+	ASSERT_EQ(2u, state.snapshot(2)->generation());
+	ASSERT_EQ(state.snapshot(), state.snapshot(3));
+	ASSERT_FALSE(state.snapshot(4));
+}
+
+TEST(NetworkStateTest, readerPinsPublishedGenerations) {
+
+	NetworkState state(2);
+	state.update(NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1"), 1000);
+
+	NetworkState::Reader reader(state);
+	const NetworkSnapshot * pinned = reader.snapshot();
+	state.update(NetworkData("172.17.0.2", "255.0.0.0", "192.168.1.1"), 2000);
+	state.update(NetworkData("172.17.0.3", "255.0.0.0", "192.168.1.1"), 3000);
+
+	// The reader keeps seeing the state as it was when opened.
+	ASSERT_EQ(1u, pinned->generation());
+	ASSERT_EQ(pinned, reader.snapshot(1));
+	ASSERT_FALSE(reader.snapshot(2));
+
+	reader.open(state);
+	ASSERT_EQ(3u, reader.snapshot()->generation());
+	ASSERT_FALSE(reader.snapshot(1));
+	ASSERT_EQ(2u, reader.snapshot(2)->generation());
+}
+
+TEST(NetworkStateTest, adoptKeepsForeignGenerations) {
+
+	NetworkState state(4);
+	ASSERT_TRUE(state.adopt(NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1"), 42, 7, 1000));
+	ASSERT_TRUE(state.adopt(NetworkData("172.17.0.2", "255.0.0.0", "192.168.1.1"), 42, 8, 2000));
+	ASSERT_FALSE(state.adopt(NetworkData("172.17.0.2", "255.0.0.0", "192.168.1.1"), 42, 8, 2000));
+	ASSERT_EQ(8u, state.snapshot()->generation());
+	ASSERT_EQ(42u, state.snapshot()->epoch());
+	ASSERT_EQ(2000, state.snapshot()->modified());
+	ASSERT_EQ(7u, state.snapshot(7)->generation());
+
+	// A gap (or a restarted updater) drops the history it cannot bridge.
+	ASSERT_TRUE(state.adopt(NetworkData("172.17.0.3", "255.0.0.0", "192.168.1.1"), 42, 11, 3000));
+	ASSERT_FALSE(state.snapshot(8));
+	ASSERT_TRUE(state.adopt(NetworkData("172.17.0.4", "255.0.0.0", "192.168.1.1"), 42, 1, 4000));
+	ASSERT_EQ(1u, state.snapshot()->generation());
+	ASSERT_FALSE(state.snapshot(11));
+
+	// So does a new epoch, even at the next or the same generation.
+	ASSERT_TRUE(state.adopt(NetworkData("172.17.0.5", "255.0.0.0", "192.168.1.1"), 43, 2, 5000));
+	ASSERT_FALSE(state.snapshot(1));
+	ASSERT_TRUE(state.adopt(NetworkData("172.17.0.6", "255.0.0.0", "192.168.1.1"), 44, 2, 6000));
+	ASSERT_EQ(44u, state.snapshot()->epoch());
+	ASSERT_EQ(6000, state.snapshot()->modified());
+}
+
+TEST(NetworkStateTest, generationIdsCarryTheEpoch) {
+
+	NetworkState one(4), other(4);
+	ASSERT_NE(0u, newEpoch());
+	one.update(NetworkData("172.17.0.1", "255.0.0.0", "192.168.1.1"), 1000);
+	other.update(NetworkData("172.17.0.2", "255.0.0.0", "192.168.1.1"), 1000);
+	ASSERT_EQ(1u, one.snapshot()->generation());
+	ASSERT_EQ(1u, other.snapshot()->generation());
+	ASSERT_NE(one.snapshot()->epoch(), other.snapshot()->epoch());
+	ASSERT_NE(one.snapshot()->generationId(), other.snapshot()->generationId());
+
+	uint64_t epoch, generation;
+	string id = one.snapshot()->generationId();
+	ASSERT_EQ(18u, id.size());
+	ASSERT_TRUE(NetworkSnapshot::parseGenerationId(id, epoch, generation));
+	ASSERT_EQ(one.snapshot()->epoch(), epoch);
+	ASSERT_EQ(1u, generation);
+
+	NetworkState::Reader reader(one);
+	ASSERT_EQ(one.snapshot().get(), reader.snapshot(epoch, 1));
+	ASSERT_FALSE(reader.snapshot(other.snapshot()->epoch(), 1));
+
+	ASSERT_FALSE(NetworkSnapshot::parseGenerationId("41", epoch, generation));
+	ASSERT_FALSE(NetworkSnapshot::parseGenerationId("00000000000000zz.1", epoch, generation));
+	ASSERT_FALSE(NetworkSnapshot::parseGenerationId("000000000000002a.", epoch, generation));
+	ASSERT_FALSE(NetworkSnapshot::parseGenerationId("000000000000002a.1x", epoch, generation));
+	ASSERT_TRUE(NetworkSnapshot::parseGenerationId("000000000000002a.41", epoch, generation));
+	ASSERT_EQ(42u, epoch);
+	ASSERT_EQ(41u, generation);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "../PathTable.h"
+
+using namespace std;
+
+TEST(PathTableTest, equalPathsShareAnId) {
+
+	PathTable table;
+	const char reply[] = "/org/freedesktop/NetworkManager/Devices/0/org/freedesktop/NetworkManager/Devices/1";
+
+	PathId first = table.intern(reply, 41);
+	PathId second = table.intern(reply + 41, 41);
+	ASSERT_NE(first, second);
+	ASSERT_EQ(first, table.intern("/org/freedesktop/NetworkManager/Devices/0"));
+	ASSERT_EQ(second, table.intern(string("/org/freedesktop/NetworkManager/Devices/1")));
+	ASSERT_EQ("/org/freedesktop/NetworkManager/Devices/1", table.name(second));
+	ASSERT_EQ(2u, table.size());
+}
+
+TEST(PathTableTest, idsSurviveGrowth) {
+
+	PathTable table;
+	vector<PathId> ids;
+	for (int i = 0; i < 5000; ++i)
+		ids.push_back(table.intern("/org/freedesktop/NetworkManager/Devices/" + to_string(i)));
+
+	for (int i = 0; i < 5000; ++i) {
+		ASSERT_EQ(PathId(i), ids[i]);
+		ASSERT_EQ(ids[i], table.intern("/org/freedesktop/NetworkManager/Devices/" + to_string(i)));
+		ASSERT_EQ("/org/freedesktop/NetworkManager/Devices/" + to_string(i), table.name(ids[i]));
+	}
+	ASSERT_THROW(table.name(5000), out_of_range);
+}
+
+TEST(PathTableTest, sweepFreesPathsNoLongerSeen) {
+
+	PathTable table;
+	PathId kept = table.intern("/org/freedesktop/NetworkManager/Devices/1");
+	PathId gone = table.intern("/org/freedesktop/NetworkManager/Devices/2");
+	table.sweep();
+	ASSERT_EQ(kept, table.intern("/org/freedesktop/NetworkManager/Devices/1"));
+	table.sweep();
+	ASSERT_EQ(kept, table.intern("/org/freedesktop/NetworkManager/Devices/1"));
+	ASSERT_EQ("/org/freedesktop/NetworkManager/Devices/2", table.name(gone)); // one interval of grace
+	table.sweep();
+	ASSERT_EQ(kept, table.intern("/org/freedesktop/NetworkManager/Devices/1"));
+	ASSERT_EQ("/org/freedesktop/NetworkManager/Devices/1", table.name(kept));
+
+	PathId next = table.intern("/org/freedesktop/NetworkManager/Devices/3");
+	ASSERT_EQ(gone, next);
+	ASSERT_EQ("/org/freedesktop/NetworkManager/Devices/3", table.name(next));
+	ASSERT_EQ(2u, table.size());
+	ASSERT_NE(gone, table.intern("/org/freedesktop/NetworkManager/Devices/2"));
+}
+
+TEST(PathTableTest, sweptTableStaysBounded) {
+
+	PathTable table;
+	for (int i = 0; i < 100000; ++i) {
+		table.intern("/org/freedesktop/NetworkManager/Devices/" + to_string(i));
+		if (i % 100 == 99)
+			table.sweep();
+	}
+	ASSERT_LE(table.size(), 300u);
+}
+
+TEST(PathTableTest, concurrentInternAgrees) {
+
+	PathTable table;
+	const int threads = 4, paths = 2000;
+	vector<vector<PathId> > ids(threads);
+	vector<thread> workers;
+	for (int t = 0; t < threads; ++t) {
+		workers.push_back(thread([&, t] {
+			for (int i = 0; i < paths; ++i) {
+				PathId id = table.intern("/org/freedesktop/NetworkManager/Devices/" + to_string(i));
+				ids[t].push_back(id);
+				table.name(id);
+			}
+		}));
+	}
+	for (size_t t = 0; t < workers.size(); ++t)
+		workers[t].join();
+
+	ASSERT_EQ(size_t(paths), table.size());
+	for (int t = 1; t < threads; ++t)
+		ASSERT_EQ(ids[0], ids[t]);
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "../Prefork.h"
+
+using namespace std;
+
+static vector<string> args(const char * script) {
+	vector<string> a;
+	a.push_back("-c");
+	a.push_back(script);
+	return a;
+}
+
+// Waits for reap() to notice exited workers; it never blocks itself.
+static int reapFor(Prefork & workers, Prefork::clock::time_point now, chrono::seconds timeout = chrono::seconds(5)) {
+	Prefork::clock::time_point deadline = Prefork::clock::now() + timeout;
+	int started;
+	while ((started = workers.reap(now)) == 0 && Prefork::clock::now() < deadline)
+		this_thread::sleep_for(chrono::milliseconds(5));
+	return started;
+}
+
+TEST(PreforkTest, restartsWorkersThatExit) {
+
+	Prefork workers("/bin/sh", args("sleep 30"), vector<string>(), -1, 2);
+	Prefork::clock::time_point t0 = Prefork::clock::now();
+	workers.start(t0);
+	vector<pid_t> before = workers.pids();
+	ASSERT_GT(before[0], 0);
+	ASSERT_GT(before[1], 0);
+
+	kill(before[1], SIGKILL);
+	ASSERT_EQ(1, reapFor(workers, t0 + chrono::seconds(2)));
+	vector<pid_t> after = workers.pids();
+	ASSERT_EQ(before[0], after[0]);
+	ASSERT_NE(before[1], after[1]);
+	ASSERT_TRUE(WIFSIGNALED(workers.lastStatus(1)));
+	ASSERT_EQ(1u, workers.restarts());
+
+	workers.stop();
+	ASSERT_EQ(0, workers.pids()[0]);
+	ASSERT_EQ(0, workers.pids()[1]);
+}
+
+TEST(PreforkTest, crashingWorkerWaitsOutMinUptime) {
+
+	Prefork workers("/bin/sh", args("exit 3"), vector<string>(), -1, 1, false, chrono::seconds(1));
+	Prefork::clock::time_point t0 = Prefork::clock::now();
+	workers.start(t0);
+
+	// Exited at once: not restarted before a second has passed.
+	Prefork::clock::time_point deadline = Prefork::clock::now() + chrono::seconds(5);
+	while (workers.pids()[0] != 0 && Prefork::clock::now() < deadline) {
+		ASSERT_EQ(0, workers.reap(t0 + chrono::milliseconds(100)));
+		this_thread::sleep_for(chrono::milliseconds(5));
+	}
+	ASSERT_EQ(3, WEXITSTATUS(workers.lastStatus(0)));
+	ASSERT_EQ(1, workers.reap(t0 + chrono::seconds(1)));
+}
+
+TEST(PreforkTest, workersKnowTheirSlotAndCpu) {
+
+	vector<string> env;
+	env.push_back("PATH=/bin:/usr/bin");
+	Prefork workers("/bin/sh", args("exit $FCGIAPP_WORKER"), env, -1, 2);
+	ASSERT_GE(workers.cpu(0), 0);
+	Prefork::clock::time_point t0 = Prefork::clock::now();
+	workers.start(t0);
+	Prefork::clock::time_point deadline = Prefork::clock::now() + chrono::seconds(5);
+	while ((workers.pids()[0] || workers.pids()[1]) && Prefork::clock::now() < deadline) {
+		workers.reap(t0);
+		this_thread::sleep_for(chrono::milliseconds(5));
+	}
+	ASSERT_EQ(0, WEXITSTATUS(workers.lastStatus(0)));
+	ASSERT_EQ(1, WEXITSTATUS(workers.lastStatus(1)));
+}
+
+TEST(PreforkTest, launchHandsOverAnFdUnderItsOwnNumber) {
+
+	int fds[2];
+	ASSERT_EQ(0, pipe2(fds, O_CLOEXEC));
+	string script = "echo handed over >&" + to_string(fds[1]);
+	pid_t pid = Prefork::launch("/bin/sh", args(script.c_str()), vector<string>(), fds[1], false);
+	ASSERT_GT(pid, 0);
+	int status;
+	ASSERT_EQ(pid, waitpid(pid, &status, 0));
+	ASSERT_EQ(0, WEXITSTATUS(status));
+
+	close(fds[1]);
+	char text[32] = { 0 };
+	ASSERT_EQ(12, read(fds[0], text, sizeof(text) - 1));
+	ASSERT_STREQ("handed over\n", text);
+	close(fds[0]);
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../Rcu.h"
+
+using namespace std;
+
+namespace {
+
+struct Tracked {
+	static std::atomic<int> live;
+	int value;
+	explicit Tracked(int value): value(value) { ++live; }
+	~Tracked() { value = -1; --live; }
+};
+std::atomic<int> Tracked::live(0);
+
+}
+
+TEST(RcuTest, retiredValueOutlivesPinnedReader) {
+
+	{
+		RcuCell<Tracked> cell;
+		cell.publish(new Tracked(1));
+
+		RcuCell<Tracked>::Reader reader(cell);
+		ASSERT_EQ(1, reader->value);
+
+		cell.publish(new Tracked(2));
+		ASSERT_EQ(2, Tracked::live.load());
+		ASSERT_EQ(1, reader->value);
+
+		reader.close();
+		cell.publish(new Tracked(3));
+		ASSERT_EQ(1, Tracked::live.load());
+
+		RcuCell<Tracked>::Reader fresh(cell);
+		ASSERT_EQ(3, fresh->value);
+	}
+	ASSERT_EQ(0, Tracked::live.load());
+}
+
+TEST(RcuTest, nestedReadersPinOnce) {
+
+	RcuCell<Tracked> cell;
+	cell.publish(new Tracked(1));
+	{
+		RcuCell<Tracked>::Reader outer(cell);
+		{
+			RcuCell<Tracked>::Reader inner(cell);
+		}
+		cell.publish(new Tracked(2));
+		ASSERT_EQ(1, outer->value); // still pinned by outer
+		ASSERT_EQ(2, Tracked::live.load());
+	}
+	cell.publish(new Tracked(3));
+	ASSERT_EQ(1, Tracked::live.load());
+}
+
+TEST(RcuTest, concurrentReadersSeeLiveValues) {
+
+	RcuCell<Tracked> cell;
+	cell.publish(new Tracked(0));
+	std::atomic<bool> done(false);
+	std::atomic<long> bad(0);
+
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 4; ++i) {
+		readers.push_back(std::thread([&] {
+			int last = 0;
+			while (!done.load()) {
+				RcuCell<Tracked>::Reader reader(cell);
+				int value = reader->value;
+				if (value < last)
+					++bad;
+				last = value;
+			}
+		}));
+	}
+	for (int i = 1; i <= 20000; ++i)
+		cell.publish(new Tracked(i));
+	done = true;
+	for (size_t i = 0; i < readers.size(); ++i)
+		readers[i].join();
+
+	ASSERT_EQ(0, bad.load());
+}
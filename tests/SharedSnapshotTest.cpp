@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <unistd.h>
+
+#include "../SharedSnapshot.h"
+
+using namespace std;
+
+class SharedSnapshotTest : public ::testing::Test {
+protected:
+	void SetUp() {
+		path = "/tmp/SharedSnapshotTest." + to_string(getpid());
+		remove(path.c_str());
+	}
+
+	void TearDown() {
+		remove(path.c_str());
+	}
+
+	static NetworkRefresher::Freshness fresh() {
+		NetworkRefresher::Freshness f = { false, false, 0 };
+		return f;
+	}
+
+	string path;
+};
+
+TEST_F(SharedSnapshotTest, readersNeedAnUpdater) {
+
+	ASSERT_THROW(SharedSnapshot(path, false), runtime_error);
+
+	SharedSnapshot updater(path, true);
+	ASSERT_THROW(SharedSnapshot(path, true), runtime_error);
+
+	SharedSnapshot reader(path, false);
+	SharedSnapshot::Record record;
+	string devices;
+	ASSERT_FALSE(reader.read(record, devices));
+}
+
+TEST_F(SharedSnapshotTest, followerMirrorsTheUpdater) {
+
+	NetworkState state;
+	DeviceState devices;
+	state.update(NetworkData("10.0.0.5", "255.255.255.0", "10.0.0.1"), 1000);
+	state.update(NetworkData("10.0.0.6", "255.255.255.0", "10.0.0.1"), 2000);
+	DeviceTable::map_type table;
+	shared_ptr<DeviceInfo> eth0(new DeviceInfo());
+	eth0->interface = "eth0";
+	eth0->mtu = 1500;
+	eth0->hasIp4Config = true;
+	eth0->ip4config.addresses.push_back(IpAddress::v4(0x0a000006, 24));
+	table["eth0"] = eth0;
+	devices.update(table, 1500);
+
+	SharedSnapshot updater(path, true);
+	SnapshotPublisher publisher(updater, state, devices);
+	ASSERT_TRUE(publisher.publish(fresh(), 2005));
+	ASSERT_FALSE(publisher.publish(fresh(), 2005));
+
+	SharedSnapshot segment(path, false);
+	NetworkState followed;
+	DeviceState followedDevices;
+	EventRing events;
+	SnapshotFollower follower(segment, followed, followedDevices, &events);
+	ASSERT_TRUE(follower.poll());
+	ASSERT_FALSE(follower.poll());
+
+	NetworkState::snapshot_pointer snapshot = followed.snapshot();
+	ASSERT_EQ(2u, snapshot->generation());
+	ASSERT_EQ(2000, snapshot->modified());
+	ASSERT_EQ(state.snapshot()->etag(), snapshot->etag());
+	ASSERT_EQ(1u, events.lastId());
+
+	DeviceState::Reader reader(followedDevices);
+	const DeviceInfo * device = reader.table()->find("eth0");
+	ASSERT_TRUE(device);
+	ASSERT_EQ(1500u, device->mtu);
+	ASSERT_EQ("10.0.0.6/24", device->ip4config.addresses.at(0).str(true));
+	ASSERT_EQ(1500, reader.table()->modified());
+
+	ASSERT_FALSE(follower.freshness(2010).stale);
+	ASSERT_EQ(5, follower.freshness(2010).age);
+	ASSERT_TRUE(follower.freshness(2020).stale); // the updater went quiet
+}
+
+TEST_F(SharedSnapshotTest, followerAdoptsARestartedUpdater) {
+
+	SharedSnapshot segment(path, true);
+	NetworkState followed;
+	DeviceState followedDevices;
+	SnapshotFollower follower(segment, followed, followedDevices);
+	{
+		NetworkState state(32, 1);
+		DeviceState devices;
+		state.update(NetworkData("10.0.0.5", "255.255.255.0", "10.0.0.1"), 1000);
+		devices.update(DeviceTable::map_type(), 1000);
+		SnapshotPublisher publisher(segment, state, devices);
+		ASSERT_TRUE(publisher.publish(fresh(), 1000));
+		ASSERT_TRUE(follower.poll());
+	}
+	NetworkState state(32, 2);
+	DeviceState devices;
+	state.update(NetworkData("10.0.0.7", "255.255.255.0", "10.0.0.1"), 3000);
+	DeviceTable::map_type table;
+	shared_ptr<DeviceInfo> eth1(new DeviceInfo());
+	eth1->interface = "eth1";
+	table["eth1"] = eth1;
+	devices.update(table, 3000);
+	SnapshotPublisher publisher(segment, state, devices);
+	ASSERT_TRUE(publisher.publish(fresh(), 3000));
+	ASSERT_TRUE(follower.poll());
+
+	NetworkState::snapshot_pointer snapshot = followed.snapshot();
+	ASSERT_EQ(1u, snapshot->generation());
+	ASSERT_EQ(2u, snapshot->epoch());
+	ASSERT_EQ(state.snapshot()->etag(), snapshot->etag());
+	DeviceState::Reader reader(followedDevices);
+	ASSERT_TRUE(reader.table()->find("eth1"));
+	ASSERT_EQ(DeviceState::Reader(devices).table()->etag("devices"), reader.table()->etag("devices"));
+}
+
+TEST_F(SharedSnapshotTest, oversizedDevicesAreReportedStale) {
+
+	NetworkState state;
+	DeviceState devices;
+	state.update(NetworkData("10.0.0.5", "255.255.255.0", "10.0.0.1"), 1000);
+	DeviceTable::map_type table;
+	shared_ptr<DeviceInfo> eth0(new DeviceInfo());
+	eth0->interface = "eth0";
+	table["eth0"] = eth0;
+	devices.update(table, 1000);
+
+	SharedSnapshot updater(path, true);
+	SnapshotPublisher publisher(updater, state, devices);
+	ASSERT_TRUE(publisher.publish(fresh(), 1000));
+	SharedSnapshot segment(path, false);
+	NetworkState followed;
+	DeviceState followedDevices;
+	SnapshotFollower follower(segment, followed, followedDevices);
+	ASSERT_TRUE(follower.poll());
+	ASSERT_FALSE(follower.devicesStale());
+
+	for (int i = 1; i < 4000; ++i) {
+		shared_ptr<DeviceInfo> device(new DeviceInfo());
+		device->interface = "veth" + to_string(i);
+		device->path = "/org/freedesktop/NetworkManager/Devices/" + to_string(i);
+		device->driver = string(64, 'd');
+		table[device->interface] = device;
+	}
+	devices.update(table, 2000);
+	ASSERT_TRUE(publisher.publish(fresh(), 2000));
+	ASSERT_TRUE(follower.poll());
+	ASSERT_TRUE(follower.devicesStale());
+	DeviceState::Reader reader(followedDevices);
+	ASSERT_EQ(1u, reader.table()->size()); // the last table that fit
+
+	devices.update(DeviceTable::map_type(), 3000);
+	ASSERT_TRUE(publisher.publish(fresh(), 3000));
+	ASSERT_TRUE(follower.poll());
+	ASSERT_FALSE(follower.devicesStale());
+	ASSERT_EQ(0u, DeviceState::Reader(followedDevices).table()->size());
+}
+
+TEST_F(SharedSnapshotTest, readsAreNeverTorn) {
+
+	SharedSnapshot updater(path, true);
+	SharedSnapshot reader(path, false);
+	atomic<bool> done(false);
+
+	thread writer([&] {
+		for (uint64_t i = 1; i <= 20000; ++i) {
+			SharedSnapshot::Record record = SharedSnapshot::Record();
+			record.generation = record.deviceGeneration = i;
+			record.modified = record.confirmed = static_cast<int64_t>(i);
+			updater.write(record, string(i % 64, char('a' + i % 26)));
+		}
+		done = true;
+	});
+	size_t reads = 0;
+	while (!done) {
+		SharedSnapshot::Record record;
+		string devices;
+		if (!reader.read(record, devices))
+			continue;
+		++reads;
+		uint64_t i = record.generation;
+		ASSERT_EQ(i, record.deviceGeneration);
+		ASSERT_EQ(static_cast<int64_t>(i), record.confirmed);
+		ASSERT_EQ(string(i % 64, char('a' + i % 26)), devices);
+	}
+	writer.join();
+	ASSERT_GT(reads, 0u);
+}
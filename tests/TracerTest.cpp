@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "../Tracer.h"
+
+using namespace std;
+
+static size_t count(const string & text, const string & what) {
+	size_t n = 0;
+	for (size_t pos = text.find(what); pos != string::npos; pos = text.find(what, pos + 1))
+		++n;
+	return n;
+}
+
+TEST(TracerTest, recordsOnlyWhileEnabled) {
+
+	Tracer tracer;
+	{
+		Tracer::Span span("off", "test", tracer);
+	}
+	ASSERT_EQ(0u, count(tracer.dump(), "\"name\""));
+	{
+		Tracer::Recording recording(tracer);
+		Tracer::Span span("on", "test", tracer);
+	}
+	ASSERT_FALSE(tracer.enabled());
+	string dump = tracer.dump();
+	ASSERT_EQ(1u, count(dump, "\"name\""));
+	ASSERT_NE(string::npos, dump.find("\"name\":\"on\",\"cat\":\"test\",\"ph\":\"X\""));
+	ASSERT_EQ(0u, dump.find("{\"traceEvents\":["));
+}
+
+TEST(TracerTest, eventsCarryTheirRequest) {
+
+	Tracer tracer;
+	tracer.enable();
+	{
+		Tracer::Request request(tracer);
+		Tracer::Span span("first", "test", tracer);
+	}
+	Tracer::Span("between", "test", tracer);
+	{
+		Tracer::Request request(tracer);
+		Tracer::Span span("second", "test", tracer);
+		span.end();
+		Tracer::Span("ended", "test", tracer).end();
+	}
+	string dump = tracer.dump();
+	ASSERT_EQ(4u, count(dump, "\"name\""));
+	ASSERT_NE(string::npos, dump.find("\"first\",\"cat\":\"test\""));
+	ASSERT_EQ(1u, count(dump, "\"args\":{\"request\":1}"));
+	ASSERT_EQ(2u, count(dump, "\"args\":{\"request\":2}"));
+	ASSERT_EQ(3u, count(dump, "\"args\""));
+}
+
+TEST(TracerTest, keepsTheNewestEventsPerThread) {
+
+	Tracer tracer;
+	tracer.enable();
+	Tracer::clock::time_point t = Tracer::clock::now();
+	for (int i = 0; i < Tracer::CAPACITY; ++i)
+		tracer.record("old", "test", t, t);
+	Tracer::clock::time_point later = t + chrono::seconds(1);
+	for (int i = 0; i < 10; ++i)
+		tracer.record("new", "test", later, later);
+	thread([&tracer, later] { tracer.record("other", "test", later, later); }).join();
+
+	string dump = tracer.dump();
+	ASSERT_EQ(size_t(Tracer::CAPACITY) + 1, count(dump, "\"name\""));
+	ASSERT_EQ(size_t(Tracer::CAPACITY) - 10, count(dump, "\"old\""));
+	ASSERT_EQ(11u, count(tracer.dump(later), "\"name\""));
+}
+
+TEST(TracerTest, dumpsWhileThreadsRecord) {
+
+	Tracer tracer;
+	tracer.enable();
+	atomic<bool> done(false);
+	vector<thread> threads;
+	for (int t = 0; t < 2; ++t)
+		threads.push_back(thread([&tracer, &done] {
+			while (!done) {
+				Tracer::Request request(tracer);
+				Tracer::Span span("busy", "test", tracer);
+			}
+		}));
+	for (int i = 0; i < 20; ++i) {
+		string dump = tracer.dump();
+		ASSERT_EQ(count(dump, "\"name\""), count(dump, "\"name\":\"busy\",\"cat\":\"test\""));
+		ASSERT_LE(count(dump, "\"name\""), 2u * Tracer::CAPACITY);
+	}
+	done = true;
+	for (size_t t = 0; t < threads.size(); ++t)
+		threads[t].join();
+}
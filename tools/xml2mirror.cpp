@@ -0,0 +1,285 @@
+// xml2mirror: generates plain C++ mirrors of D-Bus interface properties from
+// introspection XML, e.g. NetworkManagerIF.xml.
+//
+//   xml2mirror -o NetworkManagerMirror.h NetworkManagerIF.xml [more.xml ...]
+//
+// Every interface with properties becomes a struct <Name>_mirror in the
+// interface's namespace (org.freedesktop.NetworkManager.Device ->
+// org::freedesktop::NetworkManager::Device_mirror) holding one member per
+// property, with:
+//   - apply(name, iter/variant): decode one property into its member,
+//   - apply(map): a PropertiesChanged delta (a{sv}),
+//   - decode_GetAll(reply): a Properties.GetAll reply, decoded in place,
+//   - GetAll(proxy): one round trip instead of a Get per property.
+// The org.freedesktop.DBus.* interfaces are skipped.
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <cereal/external/rapidxml/rapidxml.hpp>
+
+using namespace std;
+
+struct Property {
+	string name;
+	string signature;
+};
+
+struct Interface {
+	string name;
+	vector<Property> properties;
+};
+
+// dbus-c++ type of one complete type at sig[pos], advancing pos.
+static string cppType(const string & sig, size_t & pos)
+{
+	if (pos >= sig.size())
+		throw runtime_error("truncated signature: " + sig);
+	char c = sig[pos++];
+	switch (c) {
+	case 'y': return "uint8_t";
+	case 'b': return "bool";
+	case 'n': return "int16_t";
+	case 'q': return "uint16_t";
+	case 'i': return "int32_t";
+	case 'u': return "uint32_t";
+	case 'x': return "int64_t";
+	case 't': return "uint64_t";
+	case 'd': return "double";
+	case 's': return "std::string";
+	case 'o': return "::DBus::Path";
+	case 'g': return "::DBus::Signature";
+	case 'v': return "::DBus::Variant";
+	case 'a':
+		if (pos < sig.size() && sig[pos] == '{') {
+			++pos;
+			string key = cppType(sig, pos);
+			string value = cppType(sig, pos);
+			if (pos >= sig.size() || sig[pos++] != '}')
+				throw runtime_error("bad dict entry in signature: " + sig);
+			return "std::map< " + key + ", " + value + " >";
+		}
+		return "std::vector< " + cppType(sig, pos) + " >";
+	case '(': {
+		string members;
+		while (pos < sig.size() && sig[pos] != ')')
+			members += (members.empty() ? "" : ", ") + cppType(sig, pos);
+		if (pos++ >= sig.size())
+			throw runtime_error("unterminated struct in signature: " + sig);
+		return "::DBus::Struct< " + members + " >";
+	}
+	default:
+		throw runtime_error(string("unsupported type '") + c + "' in signature: " + sig);
+	}
+}
+
+static string cppType(const string & sig)
+{
+	size_t pos = 0;
+	string type = cppType(sig, pos);
+	if (pos != sig.size())
+		throw runtime_error("property signature is not a single complete type: " + sig);
+	return type;
+}
+
+static vector<string> split(const string & s, char sep)
+{
+	vector<string> parts;
+	string::size_type begin = 0, end;
+	while ((end = s.find(sep, begin)) != string::npos) {
+		parts.push_back(s.substr(begin, end - begin));
+		begin = end + 1;
+	}
+	parts.push_back(s.substr(begin));
+	return parts;
+}
+
+static const char * attribute(rapidxml::xml_node<> * node, const char * name)
+{
+	rapidxml::xml_attribute<> * a = node->first_attribute(name);
+	return a ? a->value() : "";
+}
+
+static void readInterfaces(const char * file, vector<Interface> & interfaces)
+{
+	ifstream in(file, ios::binary);
+	if (!in)
+		throw runtime_error(string("cannot read ") + file);
+	stringstream ss;
+	ss << in.rdbuf();
+	string text = ss.str();
+	vector<char> buffer(text.begin(), text.end());
+	buffer.push_back(0);
+
+	rapidxml::xml_document<> doc;
+	doc.parse<0>(&buffer[0]);
+	rapidxml::xml_node<> * root = doc.first_node("node");
+	if (!root)
+		throw runtime_error(string(file) + ": no <node> element");
+	for (rapidxml::xml_node<> * i = root->first_node("interface"); i; i = i->next_sibling("interface")) {
+		Interface iface;
+		iface.name = attribute(i, "name");
+		if (iface.name.compare(0, 21, "org.freedesktop.DBus.") == 0)
+			continue;
+		for (rapidxml::xml_node<> * p = i->first_node("property"); p; p = p->next_sibling("property")) {
+			Property prop;
+			prop.name = attribute(p, "name");
+			prop.signature = attribute(p, "type");
+			iface.properties.push_back(prop);
+		}
+		if (!iface.properties.empty())
+			interfaces.push_back(iface);
+	}
+}
+
+static void writeInterface(ostream & os, const Interface & iface)
+{
+	vector<string> parts = split(iface.name, '.');
+	string name = parts.back();
+	parts.pop_back();
+
+	for (size_t i = 0; i < parts.size(); ++i)
+		os << "namespace " << parts[i] << " {\n";
+	os << "\n"
+	   << "struct " << name << "_mirror\n"
+	   << "{\n"
+	   << "    static const char *interface_name() { return \"" << iface.name << "\"; }\n"
+	   << "\n"
+	   << "    /* properties exported by this interface */\n";
+	for (size_t i = 0; i < iface.properties.size(); ++i) {
+		const Property & p = iface.properties[i];
+		os << "    " << cppType(p.signature) << " " << p.name << ";\n";
+	}
+	os << "\n"
+	   << "    " << name << "_mirror()\n";
+	for (size_t i = 0; i < iface.properties.size(); ++i)
+		os << "    " << (i ? ", " : ": ") << iface.properties[i].name << "()\n";
+	os << "    {\n"
+	   << "    }\n"
+	   << "\n"
+	   << "    /* Decodes one property value from vi into its member; false for names\n"
+	   << "     * this interface does not have. */\n"
+	   << "    bool apply(const std::string &name, ::DBus::MessageIter &vi)\n"
+	   << "    {\n";
+	for (size_t i = 0; i < iface.properties.size(); ++i) {
+		const Property & p = iface.properties[i];
+		os << "        " << (i ? "else if" : "if") << " (name == \"" << p.name << "\")\n";
+		if (p.signature == "v")
+			os << "            " << p.name << " = ::DBus::Variant(vi);\n";
+		else
+			os << "            vi >> " << p.name << ";\n";
+	}
+	os << "        else\n"
+	   << "            return false;\n"
+	   << "        return true;\n"
+	   << "    }\n"
+	   << "\n"
+	   << "    bool apply(const std::string &name, const ::DBus::Variant &value)\n"
+	   << "    {\n"
+	   << "        ::DBus::MessageIter vi = value.reader();\n"
+	   << "        return apply(name, vi);\n"
+	   << "    }\n"
+	   << "\n"
+	   << "    /* PropertiesChanged delta; returns the number of members updated. */\n"
+	   << "    size_t apply(const std::map< std::string, ::DBus::Variant > &props)\n"
+	   << "    {\n"
+	   << "        size_t applied = 0;\n"
+	   << "        for (std::map< std::string, ::DBus::Variant >::const_iterator it = props.begin(); it != props.end(); ++it)\n"
+	   << "            applied += apply(it->first, it->second);\n"
+	   << "        return applied;\n"
+	   << "    }\n"
+	   << "\n"
+	   << "    /* org.freedesktop.DBus.Properties.GetAll reply (a{sv}), decoded straight\n"
+	   << "     * from the message into the members. */\n"
+	   << "    size_t decode_GetAll(const ::DBus::Message &reply)\n"
+	   << "    {\n"
+	   << "        ::DBus::MessageIter ri = reply.reader();\n"
+	   << "        ::DBus::MessageIter dict = ri.recurse();\n"
+	   << "        size_t applied = 0;\n"
+	   << "        for (; !dict.at_end(); ++dict) {\n"
+	   << "            ::DBus::MessageIter entry = dict.recurse();\n"
+	   << "            std::string name;\n"
+	   << "            entry >> name;\n"
+	   << "            ::DBus::MessageIter vi = entry.recurse();\n"
+	   << "            applied += apply(name, vi);\n"
+	   << "        }\n"
+	   << "        return applied;\n"
+	   << "    }\n"
+	   << "\n"
+	   << "    /* One GetAll round trip through proxy, an object proxy for this interface. */\n"
+	   << "    size_t GetAll(::DBus::InterfaceProxy &proxy)\n"
+	   << "    {\n"
+	   << "        ::DBus::CallMessage call;\n"
+	   << "        call.member(\"GetAll\"); call.interface(\"org.freedesktop.DBus.Properties\");\n"
+	   << "        ::DBus::MessageIter wi = call.writer();\n"
+	   << "        const std::string interface = interface_name();\n"
+	   << "        wi << interface;\n"
+	   << "        ::DBus::Message ret = proxy.invoke_method(call);\n"
+	   << "        return decode_GetAll(ret);\n"
+	   << "    }\n"
+	   << "};\n"
+	   << "\n";
+	for (size_t i = parts.size(); i-- > 0;)
+		os << "} // namespace " << parts[i] << "\n";
+	os << "\n";
+}
+
+int main(int argc, char ** argv)
+{
+	string output;
+	vector<const char *> inputs;
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "-o") && i + 1 < argc)
+			output = argv[++i];
+		else
+			inputs.push_back(argv[i]);
+	}
+	if (output.empty() || inputs.empty()) {
+		cerr << "usage: xml2mirror -o <header> <introspection.xml>...\n";
+		return 2;
+	}
+
+	try {
+		vector<Interface> interfaces;
+		for (size_t i = 0; i < inputs.size(); ++i)
+			readInterfaces(inputs[i], interfaces);
+
+		string base = output.substr(output.find_last_of('/') + 1);
+		string guard = "__xml2mirror__" + base;
+		for (size_t i = 0; i < guard.size(); ++i)
+			if (!isalnum(static_cast<unsigned char>(guard[i])))
+				guard[i] = '_';
+
+		stringstream os;
+		os << "/*\n"
+		   << " *\tThis file was automatically generated by xml2mirror; DO NOT EDIT!\n"
+		   << " */\n"
+		   << "\n"
+		   << "#ifndef " << guard << "\n"
+		   << "#define " << guard << "\n"
+		   << "\n"
+		   << "#include <dbus-c++/dbus.h>\n"
+		   << "#include <map>\n"
+		   << "#include <string>\n"
+		   << "#include <vector>\n"
+		   << "\n";
+		for (size_t i = 0; i < interfaces.size(); ++i)
+			writeInterface(os, interfaces[i]);
+		os << "#endif //" << guard << "\n";
+
+		ofstream out(output.c_str(), ios::binary);
+		out << os.str();
+		if (!out)
+			throw runtime_error("cannot write " + output);
+	} catch (const exception & e) {
+		cerr << "xml2mirror: " << e.what() << "\n";
+		return 1;
+	}
+	return 0;
+}